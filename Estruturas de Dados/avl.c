@@ -97,17 +97,86 @@ binária de procura, T2 passa para a sub-árvore direita de A.
 
 
 // Definições auxiliares para algoritmos de AVL em C
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
 
-#define LH 1; // a sub-árvore da esquerda é mais pesada
-#define EH 0; // árvore balanceada
-#define RH -1; // a sub-árvore da direita é mais pesada
+#define LH 1 // a sub-árvore da esquerda é mais pesada
+#define EH 0 // árvore balanceada
+#define RH -1 // a sub-árvore da direita é mais pesada
+
+/* Árvores de estatísticas de ordem
+   -> Se AVL_ORDEM estiver definido (antes de incluir este ficheiro ou com -DAVL_ORDEM), cada nodo guarda também o tamanho da sua sub-árvore;
+   -> O tamanho só muda nos nodos do caminho percorrido por uma inserção / remoção e nos nodos envolvidos numa rotação, logo, mantê-lo
+não altera a complexidade de nenhuma operação. Em troca, rank, select e countRange passam a custar O(log N) em vez de O(N).
+*/
 
 typedef struct tree{
     int bf;
     int key, info;
-    struct tree *left, *right
+#ifdef AVL_ORDEM
+    int size;      // nº de nodos da sub-árvore
+#endif
+    struct tree *left, *right;
 } *Tree;
 
+#ifdef AVL_ORDEM
+#define SIZE(a) ((a) == NULL ? 0 : (a) -> size)
+#define FIXSIZE(a) ((a) -> size = 1 + SIZE((a) -> left) + SIZE((a) -> right))
+#else
+#define FIXSIZE(a) ((void) 0)
+#endif
+
+/* Reserva de nodos
+   -> Os nodos não são reservados um a um com malloc: reserva-se um slab com AVL_SLAB nodos de cada vez;
+   -> Os nodos removidos são colocados numa lista de nodos livres (ligada pelo campo right), que é usada antes de se reservar um novo slab;
+   -> O pool é local a cada thread, logo, newNode e freeNode não precisam de sincronização (um nodo libertado noutra thread
+      fica simplesmente no pool dessa thread).
+*/
+
+#define AVL_SLAB 1024
+
+typedef struct {
+    Tree livres;   // lista de nodos livres
+    Tree *slabs;
+    int nslabs, cap;
+} PoolAVL;
+
+static _Thread_local PoolAVL poolAVL;
+
+// Função que devolve um novo nodo (folha) com a chave k e a informação i
+Tree newNode (int k, int i){
+    Tree a;
+    int j;
+    if (poolAVL.livres == NULL){
+        if (poolAVL.nslabs == poolAVL.cap){
+            poolAVL.cap = poolAVL.cap ? 2 * poolAVL.cap : 16;
+            poolAVL.slabs = realloc (poolAVL.slabs, poolAVL.cap * sizeof(Tree));
+        }
+        a = poolAVL.slabs[poolAVL.nslabs++] = malloc (AVL_SLAB * sizeof(struct tree));
+        for (j = 0; j < AVL_SLAB; j++){
+            a[j].right = poolAVL.livres;
+            poolAVL.livres = &a[j];
+        }
+    }
+    a = poolAVL.livres;
+    poolAVL.livres = a -> right;
+    a -> key = k;
+    a -> info = i;
+    a -> bf = EH;
+    a -> left = a -> right = NULL;
+    FIXSIZE(a);
+    return a;
+}
+
+// Função que devolve um nodo ao pool
+void freeNode (Tree a){
+    a -> right = poolAVL.livres;
+    poolAVL.livres = a;
+}
+
 // Função que faz a rotação à esquerda necessária em 3.a
 
 // requires (t != NULL) && (t -> right != NULL)
@@ -115,6 +184,8 @@ Tree rotateLeft (Tree t){
     Tree aux = t -> right;
     t -> right = aux -> left;
     aux -> left = t;
+    FIXSIZE(t);
+    FIXSIZE(aux);
     t = aux;
     return t;
 }
@@ -126,21 +197,29 @@ Tree rotateRight (Tree t){
   Tree aux = t -> left;
   t -> left = aux -> right;
   aux -> right = t;
+  FIXSIZE(t);
+  FIXSIZE(aux);
   t = aux;
   return t;
 }
 
 
 // Função que balanceia uma árvore que deixou de respeitar o invariante por uma inserção de um elemento à direita
+// (ou por uma remoção à esquerda, caso em que aux1 pode estar balanceada)
 
 // requires (t != NULL) && (t -> right != NULL)
 Tree balanceRight (Tree t){
   Tree aux1, aux2;
   aux1 = t -> right;
-  if (aux1 -> bf = RH){
+  if (aux1 -> bf == RH){
     t -> bf = aux1 -> bf = EH;
     t = rotateLeft(t);
   }
+  else if (aux1 -> bf == EH){ // só acontece na remoção (a altura da árvore não diminui) ou no join (a altura aumenta)
+    t -> bf = RH;
+    aux1 -> bf = LH;
+    t = rotateLeft(t);
+  }
   else{
     aux2 = aux1 -> left;
     switch (aux2 -> bf){
@@ -153,19 +232,20 @@ Tree balanceRight (Tree t){
         break;
       case RH:
         t -> bf = LH;
-        aux1 -> bf = BAL;
+        aux1 -> bf = EH;
         break;
     }
     aux2 -> bf = EH;
     t -> right = rotateRight (aux1);
     t = rotateLeft (t);
   }
-  return a;
+  return t;
 }
 
 // Função que balanceia uma árvore que deixou de respeitar o invariante por uma inserção de um elemento à esquerda
+// (ou por uma remoção à direita, caso em que aux1 pode estar balanceada)
 
-// requires (t != NULL) && (t -> right != NULL)
+// requires (t != NULL) && (t -> left != NULL)
 Tree balanceLeft (Tree t){
   Tree aux1, aux2;
   aux1 = t -> left;
@@ -173,6 +253,11 @@ Tree balanceLeft (Tree t){
     t -> bf = aux1 -> bf = EH;
     t = rotateRight (t);
   }
+  else if (aux1 -> bf == EH){ // só acontece na remoção (a altura da árvore não diminui) ou no join (a altura aumenta)
+    t -> bf = LH;
+    aux1 -> bf = RH;
+    t = rotateRight (t);
+  }
   else{
     aux2 = aux1 -> right;
     switch (aux2 -> bf){
@@ -184,11 +269,11 @@ Tree balanceLeft (Tree t){
         aux1 -> bf = EH;
         break;
       case RH:
-        t -> bf = BAL;
-        aux1 -> bf = LEFT;
+        t -> bf = EH;
+        aux1 -> bf = LH;
         break;
     }
-    aux2 -> bal = BAL;
+    aux2 -> bf = EH;
     t -> left = rotateLeft(aux1);
     t = rotateRight (t);
   }
@@ -200,6 +285,8 @@ Tree balanceLeft (Tree t){
 
 // Função que atualiza uma AVL recursivamente
 
+Tree updateAVLRec (Tree a, int k, int i, int *g, int *u);
+
 int updateAVL (Tree *a, int k, int i){
   int g, u;
   *a = updateAVLRec (*a, k, i, &g, &u);
@@ -208,11 +295,7 @@ int updateAVL (Tree *a, int k, int i){
 
 Tree updateAVLRec (Tree a, int k, int i, int *g, int *u){
   if (a == NULL){
-    a = malloc (sizeof (struct tree));
-    a -> key = k;
-    a -> info = i;
-    a -> bal = EH;
-    a -> left = a -> right = NULL;
+    a = newNode (k, i);
     *g = 1; 
     *u = 0;
   }
@@ -224,16 +307,16 @@ Tree updateAVLRec (Tree a, int k, int i, int *g, int *u){
   else if (a -> key > k){
     a -> left = updateAVLRec(a -> left, k, i, g, u);
     if (*g == 1)
-      switch (a -> bal){
+      switch (a -> bf){
         case LH:
           a = balanceLeft(a);
           *g = 0;
           break;
         case EH:
-          a -> bal = LH;
+          a -> bf = LH;
           break;
         case RH:
-          a -> bal = EH;
+          a -> bf = EH;
           *g = 0;
           break;
       }
@@ -241,20 +324,889 @@ Tree updateAVLRec (Tree a, int k, int i, int *g, int *u){
   else {
     a -> right = updateAVLRec(a -> right, k, i, g, u);
     if (*g == 1)
-      switch (a -> bal){
+      switch (a -> bf){
         case RH:
           a = balanceRight(a);
           *g = 0;
           break;
         case EH:
-          a -> bal = RH; 
+          a -> bf = RH; 
           break;
         case LH:
-          a -> bal = EH;
+          a -> bf = EH;
           *g = 0;
           break;
       }
   }
+  FIXSIZE(a);
+  return a;
+}
+
+
+// Função que procura uma chave numa AVL (devolve 1 e coloca a informação em *i se a chave existir, 0 caso contrário)
+
+int lookupAVL (Tree a, int k, int *i){
+  while (a != NULL && a -> key != k)
+    a = (k < a -> key) ? a -> left : a -> right;
+  if (a == NULL) return 0;
+  *i = a -> info;
+  return 1;
+}
+// A Complexidade desta função é dada por: T(N) = O(log N), pois a altura de uma AVL é O(log N)
+
+// Funções que devolvem o nodo com a menor / maior chave (NULL se a árvore for vazia)
+
+Tree minAVL (Tree a){
+  if (a != NULL)
+    while (a -> left != NULL) a = a -> left;
+  return a;
+}
+
+Tree maxAVL (Tree a){
+  if (a != NULL)
+    while (a -> right != NULL) a = a -> right;
+  return a;
+}
+
+/* Sucessor e antecessor
+   -> Como os nodos não têm apontador para o pai, o sucessor de k é procurado a partir da raíz:
+      sempre que descemos para a esquerda, o nodo atual é a menor chave > k encontrada até ao momento.
+   -> A chave k não tem de existir na árvore.
+*/
+
+// Função que devolve o nodo com a menor chave > k (NULL se não existir)
+
+Tree succAVL (Tree a, int k){
+  Tree r = NULL;
+  while (a != NULL)
+    if (k < a -> key){
+      r = a;
+      a = a -> left;
+    }
+    else a = a -> right;
+  return r;
+}
+
+// Função que devolve o nodo com a maior chave < k (NULL se não existir)
+
+Tree predAVL (Tree a, int k){
+  Tree r = NULL;
+  while (a != NULL)
+    if (k > a -> key){
+      r = a;
+      a = a -> right;
+    }
+    else a = a -> left;
+  return r;
+}
+
+/* Algoritmo de remoção de um elemento de uma árvore AVL
+   -> Se o nodo a remover tem no máximo um filho, é substituído por esse filho;
+   -> Caso contrário, o nodo fica com a chave (e a informação) do seu sucessor, que é o mínimo da sub-árvore direita, e é esse mínimo que é removido.
+   -> Quando a altura de uma sub-árvore diminui (*d == 1), o pai pode deixar de respeitar o invariante. Ao contrário da inserção, uma rotação pode
+não repor a altura original, logo, o rebalanceamento pode ter de continuar até à raíz:
+      - remoção à esquerda: é como uma inserção à direita (usamos o balanceRight);
+      - remoção à direita: é como uma inserção à esquerda (usamos o balanceLeft);
+      - após uma rotação, a altura só diminuiu se a nova raíz ficou balanceada.
+*/
+
+// Função auxiliar que atualiza o fator de balanço de a depois de a altura da sub-árvore esquerda ter diminuído
+
+Tree shrunkLeft (Tree a, int *d){
+  switch (a -> bf){
+    case LH:
+      a -> bf = EH;
+      break;
+    case EH:
+      a -> bf = RH;
+      *d = 0;
+      break;
+    case RH:
+      a = balanceRight (a);
+      *d = (a -> bf == EH);
+      break;
+  }
   return a;
 }
 
+// Função auxiliar que atualiza o fator de balanço de a depois de a altura da sub-árvore direita ter diminuído
+
+Tree shrunkRight (Tree a, int *d){
+  switch (a -> bf){
+    case RH:
+      a -> bf = EH;
+      break;
+    case EH:
+      a -> bf = LH;
+      *d = 0;
+      break;
+    case LH:
+      a = balanceLeft (a);
+      *d = (a -> bf == EH);
+      break;
+  }
+  return a;
+}
+
+// Função auxiliar que remove o mínimo de a, colocando-o em *m (requires a != NULL)
+
+Tree deleteMinAVL (Tree a, Tree *m, int *d){
+  if (a -> left == NULL){
+    *m = a;
+    *d = 1;
+    return a -> right;
+  }
+  a -> left = deleteMinAVL (a -> left, m, d);
+  if (*d) a = shrunkLeft (a, d);
+  FIXSIZE(a);
+  return a;
+}
+
+Tree deleteAVLRec (Tree a, int k, int *d, int *r){
+  Tree m;
+  if (a == NULL){
+    *d = 0;
+    *r = 0;
+  }
+  else if (k < a -> key){
+    a -> left = deleteAVLRec (a -> left, k, d, r);
+    if (*d) a = shrunkLeft (a, d);
+    FIXSIZE(a);
+  }
+  else if (k > a -> key){
+    a -> right = deleteAVLRec (a -> right, k, d, r);
+    if (*d) a = shrunkRight (a, d);
+    FIXSIZE(a);
+  }
+  else {
+    *r = 1;
+    *d = 1;
+    m = a;
+    if (a -> left == NULL) a = a -> right;
+    else if (a -> right == NULL) a = a -> left;
+    else {
+      // o sucessor (mínimo da direita) passa a ocupar o lugar de a
+      a -> right = deleteMinAVL (a -> right, &m, d);
+      a -> key = m -> key;
+      a -> info = m -> info;
+      if (*d) a = shrunkRight (a, d);
+      FIXSIZE(a);
+    }
+    freeNode (m);
+  }
+  return a;
+}
+
+// Função que remove uma chave de uma AVL (devolve 1 se a chave existia)
+
+int deleteAVL (Tree *a, int k){
+  int d, r;
+  *a = deleteAVLRec (*a, k, &d, &r);
+  return r;
+}
+// A Complexidade desta função é dada por: T(N) = O(log N)
+
+// Função que liberta uma AVL
+
+void freeAVL (Tree a){
+  if (a != NULL){
+    freeAVL (a -> left);
+    freeAVL (a -> right);
+    freeNode (a);
+  }
+}
+
+/* Travessia inorder não recursiva (iteradores)
+   -> O iterador guarda numa stack o caminho desde a raíz até ao próximo nodo a visitar (os nodos cuja sub-árvore esquerda já foi visitada,
+mas que ainda não foram visitados eles próprios);
+   -> Como a altura de uma AVL com N nodos é inferior a 1.44 * log2(N + 2), uma stack com AVL_MAX_ALT posições chega para qualquer árvore em memória;
+   -> Cada nextIter custa O(1) amortizado (cada nodo entra e sai da stack uma vez).
+*/
+
+#define AVL_MAX_ALT 64
+
+typedef struct {
+  Tree pilha[AVL_MAX_ALT];
+  int sp;     // nº de nodos na stack
+  int rev;    // 1 se o iterador percorre as chaves por ordem decrescente
+} IterAVL;
+
+// Função auxiliar que empilha o caminho desde a até ao seu menor (ou maior, se rev) elemento
+
+void pushSpine (IterAVL *it, Tree a){
+  while (a != NULL){
+    it -> pilha[it -> sp++] = a;
+    a = it -> rev ? a -> right : a -> left;
+  }
+}
+
+// Função que inicia um iterador por ordem crescente das chaves
+
+void initIter (IterAVL *it, Tree a){
+  it -> sp = 0;
+  it -> rev = 0;
+  pushSpine (it, a);
+}
+
+// Função que inicia um iterador por ordem decrescente das chaves
+
+void initIterRev (IterAVL *it, Tree a){
+  it -> sp = 0;
+  it -> rev = 1;
+  pushSpine (it, a);
+}
+
+// Função que inicia um iterador por ordem crescente a partir da primeira chave >= k
+
+void initIterFrom (IterAVL *it, Tree a, int k){
+  it -> sp = 0;
+  it -> rev = 0;
+  while (a != NULL)
+    if (k <= a -> key){
+      it -> pilha[it -> sp++] = a; // a ainda vai ser visitado
+      a = a -> left;
+    }
+    else a = a -> right;         // a e a sua sub-árvore esquerda ficam de fora
+}
+
+// Função que avança o iterador (devolve 0 quando já não há elementos)
+
+int nextIter (IterAVL *it, int *k, int *i){
+  Tree a;
+  if (it -> sp == 0) return 0;
+  a = it -> pilha[--(it -> sp)];
+  *k = a -> key;
+  *i = a -> info;
+  pushSpine (it, it -> rev ? a -> left : a -> right);
+  return 1;
+}
+
+/* Inserção e remoção iterativas
+   As versões recursivas (updateAVL, deleteAVL) percorrem a altura da árvore duas vezes (descida e regresso da recursão), devolvendo flags
+ao nível de cima. As versões seguintes não usam recursão:
+   -> Inserção: durante a descida guardamos o nodo desbalanceado (bf != EH) mais profundo do caminho, s. Abaixo de s todos os nodos do
+caminho estão balanceados, logo, após inserir a folha:
+        - os nodos entre s e a folha passam a pender para o lado por onde descemos;
+        - se s estava balanceado (só acontece se s for a raíz) passa a pender para esse lado;
+        - se s pendia para o lado contrário fica balanceado;
+        - se s pendia para o mesmo lado, uma rotação (simples ou dupla) em s repõe a altura que a sub-árvore tinha antes da inserção.
+      Em qualquer caso, nenhum nodo acima de s é alterado.
+   -> Remoção: guardamos numa stack (de AVL_MAX_ALT posições) os apontadores percorridos na descida e, após retirar o nodo, subimos pela
+stack enquanto a altura da sub-árvore diminuir.
+*/
+
+// Função que atualiza uma AVL sem recursão (devolve 1 se a chave já existia)
+
+int updateAVLIter (Tree *a, int k, int i){
+  Tree *ps, *p, s, x;
+  int dir;
+  if (*a == NULL){
+    *a = newNode (k, i);
+    return 0;
+  }
+  ps = p = a;  // ps aponta para o apontador para s
+  while (*p != NULL){
+    if ((*p) -> key == k){
+      (*p) -> info = i;
+      return 1;
+    }
+    if ((*p) -> bf != EH) ps = p;
+    p = (k < (*p) -> key) ? &(*p) -> left : &(*p) -> right;
+  }
+  *p = newNode (k, i);
+#ifdef AVL_ORDEM
+  for (x = *a; x -> key != k; x = (k < x -> key) ? x -> left : x -> right)
+    x -> size++;
+#endif
+  s = *ps;
+  dir = (k < s -> key) ? LH : RH;
+  for (x = (dir == LH) ? s -> left : s -> right; x -> key != k; x = (k < x -> key) ? x -> left : x -> right)
+    x -> bf = (k < x -> key) ? LH : RH;
+  if (s -> bf == EH) s -> bf = dir;
+  else if (s -> bf != dir) s -> bf = EH;
+  else *ps = (dir == LH) ? balanceLeft (s) : balanceRight (s);
+  return 0;
+}
+// A Complexidade desta função é dada por: T(N) = O(log N), com no máximo uma rotação (simples ou dupla)
+
+// Função que remove uma chave de uma AVL sem recursão (devolve 1 se a chave existia)
+
+int deleteAVLIter (Tree *a, int k){
+  Tree *path[AVL_MAX_ALT], *p = a, m;
+  int dir[AVL_MAX_ALT], n = 0, d;
+  while (*p != NULL && (*p) -> key != k){
+    path[n] = p;
+    dir[n++] = (k < (*p) -> key) ? LH : RH;
+    p = (k < (*p) -> key) ? &(*p) -> left : &(*p) -> right;
+  }
+  if (*p == NULL) return 0;
+  m = *p;
+  if (m -> left != NULL && m -> right != NULL){
+    // o sucessor (mínimo da direita) passa a ocupar o lugar de m e é o nodo do sucessor que sai da árvore
+    path[n] = p;
+    dir[n++] = RH;
+    p = &m -> right;
+    while ((*p) -> left != NULL){
+      path[n] = p;
+      dir[n++] = LH;
+      p = &(*p) -> left;
+    }
+    m -> key = (*p) -> key;
+    m -> info = (*p) -> info;
+    m = *p;
+  }
+  *p = (m -> left != NULL) ? m -> left : m -> right;
+  freeNode (m);
+#ifdef AVL_ORDEM
+  for (d = 0; d < n; d++)
+    (*path[d]) -> size--;
+#endif
+  for (d = 1; d && n > 0; ){
+    n--;
+    *path[n] = (dir[n] == LH) ? shrunkLeft (*path[n], &d) : shrunkRight (*path[n], &d);
+  }
+  return 1;
+}
+// A Complexidade desta função é dada por: T(N) = O(log N)
+
+/* Construção, split e join
+   -> Como os nodos só guardam o fator de balanço, a altura de uma AVL calcula-se descendo sempre pelo lado mais pesado: O(log N).
+      As funções seguintes recebem e devolvem as alturas das sub-árvores, para não terem de as recalcular.
+   -> join (t1, m, t2), com todas as chaves de t1 < m -> key < todas as chaves de t2:
+        - se as alturas de t1 e t2 diferem no máximo em 1, m passa a ser a raíz com t1 e t2 como filhos;
+        - se t1 é mais alta, descemos pela "espinha" direita de t1 até uma sub-árvore c com altura <= altura(t2) + 1 e colocamos m no lugar
+          de c, com c e t2 como filhos. A altura aumentou 1 nesse ponto, logo, subimos como numa inserção à direita (usando o balanceRight);
+        - se t2 é mais alta, o processo é o simétrico.
+        Custo: O(|altura(t1) - altura(t2)| + 1).
+   -> split (t, k) divide t nas chaves < k e nas chaves > k, fazendo joins ao longo do caminho até k: O(log N).
+*/
+
+// Função que calcula a altura de uma AVL
+
+int heightAVL (Tree a){
+  int h = 0;
+  for (; a != NULL; h++) a = (a -> bf == RH) ? a -> right : a -> left;
+  return h;
+}
+
+// Função auxiliar que constrói a AVL com as chaves keys[lo .. hi - 1] (colocando a sua altura em *h)
+
+Tree buildAVLRec (int keys[], int infos[], int lo, int hi, int *h){
+  Tree a;
+  int m = (lo + hi) / 2, hl, hr;
+  if (lo >= hi){
+    *h = 0;
+    return NULL;
+  }
+  a = newNode (keys[m], infos[m]);
+  a -> left = buildAVLRec (keys, infos, lo, m, &hl);
+  a -> right = buildAVLRec (keys, infos, m + 1, hi, &hr);
+  a -> bf = hl - hr;   // a metade esquerda nunca tem menos elementos do que a direita, logo, hl - hr é 0 ou 1
+  FIXSIZE(a);
+  *h = 1 + (hl > hr ? hl : hr);
+  return a;
+}
+
+// Função que constrói uma AVL a partir de um array de n chaves ordenadas (estritamente crescentes) e das respetivas informações
+
+Tree buildAVL (int keys[], int infos[], int n){
+  int h;
+  return buildAVLRec (keys, infos, 0, n, &h);
+}
+// A Complexidade desta função é dada por: T(N) = Theta(N), sem nenhuma rotação
+
+// Funções auxiliares do join: *g fica a 1 se a árvore devolvida é mais alta (em 1) do que t1 (joinRight) ou t2 (joinLeft)
+
+Tree joinRight (Tree t1, int h1, Tree m, Tree t2, int h2, int *g){
+  if (h1 <= h2 + 1){
+    m -> left = t1;
+    m -> right = t2;
+    m -> bf = h1 - h2;
+    FIXSIZE(m);
+    *g = 1;
+    return m;
+  }
+  t1 -> right = joinRight (t1 -> right, h1 - (t1 -> bf == LH ? 2 : 1), m, t2, h2, g);
+  FIXSIZE(t1);
+  if (*g)
+    switch (t1 -> bf){
+      case LH:
+        t1 -> bf = EH;
+        *g = 0;
+        break;
+      case EH:
+        t1 -> bf = RH;
+        break;
+      case RH:
+        t1 = balanceRight (t1);
+        *g = (t1 -> bf != EH);
+        break;
+    }
+  return t1;
+}
+
+Tree joinLeft (Tree t1, int h1, Tree m, Tree t2, int h2, int *g){
+  if (h2 <= h1 + 1){
+    m -> left = t1;
+    m -> right = t2;
+    m -> bf = h1 - h2;
+    FIXSIZE(m);
+    *g = 1;
+    return m;
+  }
+  t2 -> left = joinLeft (t1, h1, m, t2 -> left, h2 - (t2 -> bf == RH ? 2 : 1), g);
+  FIXSIZE(t2);
+  if (*g)
+    switch (t2 -> bf){
+      case RH:
+        t2 -> bf = EH;
+        *g = 0;
+        break;
+      case EH:
+        t2 -> bf = LH;
+        break;
+      case LH:
+        t2 = balanceLeft (t2);
+        *g = (t2 -> bf != EH);
+        break;
+    }
+  return t2;
+}
+
+// Função auxiliar que junta t1 (altura h1), o nodo m e t2 (altura h2), colocando a altura do resultado em *h
+
+Tree joinH (Tree t1, int h1, Tree m, Tree t2, int h2, int *h){
+  int g;
+  if (h1 > h2 + 1){
+    t1 = joinRight (t1, h1, m, t2, h2, &g);
+    *h = h1 + g;
+    return t1;
+  }
+  if (h2 > h1 + 1){
+    t2 = joinLeft (t1, h1, m, t2, h2, &g);
+    *h = h2 + g;
+    return t2;
+  }
+  m -> left = t1;
+  m -> right = t2;
+  m -> bf = h1 - h2;
+  FIXSIZE(m);
+  *h = 1 + (h1 > h2 ? h1 : h2);
+  return m;
+}
+
+// Função auxiliar que junta duas árvores sem nodo do meio (o mínimo de t2 passa a ser o nodo do meio)
+
+Tree join2H (Tree t1, int h1, Tree t2, int h2, int *h){
+  Tree m;
+  int d;
+  if (t2 == NULL){
+    *h = h1;
+    return t1;
+  }
+  t2 = deleteMinAVL (t2, &m, &d);
+  return joinH (t1, h1, m, t2, h2 - d, h);
+}
+
+// Função auxiliar do split: o nodo com a chave k (se existir) é retirado da árvore e colocado em *m
+
+void splitH (Tree t, int h, int k, Tree *l, int *hl, Tree *r, int *hr, Tree *m){
+  Tree x;
+  int hx, hL, hR;
+  if (t == NULL){
+    *l = *r = *m = NULL;
+    *hl = *hr = 0;
+    return;
+  }
+  hL = h - (t -> bf == RH ? 2 : 1);
+  hR = h - (t -> bf == LH ? 2 : 1);
+  if (k == t -> key){
+    *l = t -> left; *hl = hL;
+    *r = t -> right; *hr = hR;
+    *m = t;
+  }
+  else if (k < t -> key){
+    splitH (t -> left, hL, k, l, hl, &x, &hx, m);
+    *r = joinH (x, hx, t, t -> right, hR, hr);
+  }
+  else {
+    splitH (t -> right, hR, k, &x, &hx, r, hr, m);
+    *l = joinH (t -> left, hL, t, x, hx, hl);
+  }
+}
+
+// Função que junta t1, a chave k (com informação i) e t2 (requires todas as chaves de t1 < k < todas as chaves de t2)
+
+Tree joinAVL (Tree t1, int k, int i, Tree t2){
+  int h;
+  return joinH (t1, heightAVL (t1), newNode (k, i), t2, heightAVL (t2), &h);
+}
+
+// Função que divide t nas árvores *l (chaves < k) e *r (chaves > k); devolve 1 (e a informação de k em *i) se k existia em t
+
+int splitAVL (Tree t, int k, Tree *l, Tree *r, int *i){
+  Tree m;
+  int hl, hr;
+  splitH (t, heightAVL (t), k, l, &hl, r, &hr, &m);
+  if (m == NULL) return 0;
+  *i = m -> info;
+  freeNode (m);
+  return 1;
+}
+
+/* União, interseção e diferença
+   Usando o split e o join, as operações sobre conjuntos ficam com uma estrutura "dividir para conquistar":
+        op (t1, t2): m = raíz de t2; dividir t1 por m -> key em l1 e r1; calcular op (l1, t2 -> left) e op (r1, t2 -> right); juntar com (ou sem) m.
+   -> União: m (ou o nodo de t1 com a mesma chave, cuja informação prevalece) fica sempre;
+   -> Interseção: fica o nodo de t1 apenas se a chave existir nas duas árvores;
+   -> Diferença (t1 \ t2): m nunca fica, nem o nodo de t1 com a mesma chave.
+   As duas chamadas recursivas são independentes, logo, quando as árvores são grandes, a da esquerda é feita numa nova thread.
+   Os nodos são reaproveitados (as árvores de entrada deixam de existir). Os nodos descartados são juntos numa lista (lixo), libertada no fim pela
+thread que chamou a operação, para voltarem ao seu pool.
+   A Complexidade destas operações é dada por: T(N, M) = O(M * log(N / M + 1)), com M <= N os tamanhos das árvores.
+*/
+
+#define UNIAO 0
+#define INTERSECAO 1
+#define DIFERENCA 2
+
+#define PAR_ALT 14 // só se lança uma thread se uma das árvores tiver pelo menos esta altura
+
+// Função auxiliar que coloca os nodos de a na lista lixo (ligada pelo campo right)
+
+void discardAVL (Tree a, Tree *lixo){
+  if (a != NULL){
+    discardAVL (a -> left, lixo);
+    discardAVL (a -> right, lixo);
+    a -> right = *lixo;
+    *lixo = a;
+  }
+}
+
+Tree setOpH (int op, Tree t1, int h1, Tree t2, int h2, int *h, Tree *lixo, int par);
+
+typedef struct {
+  int op, h1, h2, h, par;
+  Tree t1, t2, r, lixo;
+} ArgSetOp;
+
+void *setOpThread (void *arg){
+  ArgSetOp *a = arg;
+  a -> r = setOpH (a -> op, a -> t1, a -> h1, a -> t2, a -> h2, &a -> h, &a -> lixo, a -> par);
+  return NULL;
+}
+
+Tree setOpH (int op, Tree t1, int h1, Tree t2, int h2, int *h, Tree *lixo, int par){
+  Tree m, dup, l1, r1, l2, r2, b, x;
+  int hl1, hr1, hl2, hr2, hb;
+  ArgSetOp a;
+  pthread_t th;
+  if (t1 == NULL || t2 == NULL){
+    if (op == UNIAO){
+      *h = (t1 == NULL) ? h2 : h1;
+      return (t1 == NULL) ? t2 : t1;
+    }
+    discardAVL (t2, lixo);
+    if (op == INTERSECAO){
+      discardAVL (t1, lixo);
+      t1 = NULL;
+      h1 = 0;
+    }
+    *h = h1;
+    return t1;
+  }
+  m = t2;
+  l2 = m -> left; hl2 = h2 - (m -> bf == RH ? 2 : 1);
+  r2 = m -> right; hr2 = h2 - (m -> bf == LH ? 2 : 1);
+  splitH (t1, h1, m -> key, &l1, &hl1, &r1, &hr1, &dup);
+  a = (ArgSetOp) { op, hl1, hl2, 0, par - 1, l1, l2, NULL, NULL };
+  if (par > 0 && (h1 >= PAR_ALT || h2 >= PAR_ALT) && pthread_create (&th, NULL, setOpThread, &a) == 0){
+    b = setOpH (op, r1, hr1, r2, hr2, &hb, lixo, par - 1);
+    pthread_join (th, NULL);
+    for (x = a.lixo; x != NULL; x = r2){   // juntar o lixo da outra thread
+      r2 = x -> right;
+      x -> right = *lixo;
+      *lixo = x;
+    }
+  }
+  else {
+    a.r = setOpH (op, l1, hl1, l2, hl2, &a.h, lixo, 0);
+    b = setOpH (op, r1, hr1, r2, hr2, &hb, lixo, 0);
+  }
+  if (op == UNIAO || (op == INTERSECAO && dup != NULL)){
+    if (dup != NULL){
+      m -> right = *lixo;
+      *lixo = m;
+      m = dup;
+    }
+    return joinH (a.r, a.h, m, b, hb, h);
+  }
+  m -> right = *lixo;
+  *lixo = m;
+  if (dup != NULL){
+    dup -> right = *lixo;
+    *lixo = dup;
+  }
+  return join2H (a.r, a.h, b, hb, h);
+}
+
+// Função auxiliar que executa uma operação sobre conjuntos com até nthreads threads
+
+Tree setOpAVL (int op, Tree t1, Tree t2, int nthreads){
+  Tree r, lixo = NULL, x;
+  int h, par = 0;
+  while ((2 << par) <= nthreads) par++;   // cada nível de recursão com uma nova thread duplica o nº de threads
+  r = setOpH (op, t1, heightAVL (t1), t2, heightAVL (t2), &h, &lixo, par);
+  for (; lixo != NULL; lixo = x){
+    x = lixo -> right;
+    freeNode (lixo);
+  }
+  return r;
+}
+
+Tree unionAVL (Tree t1, Tree t2, int nthreads){
+  return setOpAVL (UNIAO, t1, t2, nthreads);
+}
+
+Tree intersectAVL (Tree t1, Tree t2, int nthreads){
+  return setOpAVL (INTERSECAO, t1, t2, nthreads);
+}
+
+Tree differenceAVL (Tree t1, Tree t2, int nthreads){
+  return setOpAVL (DIFERENCA, t1, t2, nthreads);
+}
+
+/* Consultas por intervalos
+   -> Um IterRange percorre, por ordem crescente, as chaves de [lo, hi], devolvendo-as em lotes (nextBatch preenche até max pares de cada vez),
+      o que evita uma chamada por elemento em consultas de paginação;
+   -> Com AVL_ORDEM:
+        - rank (k) é o nº de chaves < k: ao descer para a direita somamos o tamanho da sub-árvore esquerda mais o próprio nodo;
+        - select (i) é o nodo com a i-ésima menor chave (a partir de 0): comparamos i com o tamanho da sub-árvore esquerda;
+        - countRange (lo, hi) = rank (hi) + (hi ocorre) - rank (lo).
+      Todas custam O(log N). Uma página que começa na posição i obtém-se com initRangeAt.
+*/
+
+typedef struct {
+  IterAVL it;
+  int hi;
+} IterRange;
+
+// Função que inicia um iterador para as chaves de [lo, hi]
+
+void initRange (IterRange *r, Tree a, int lo, int hi){
+  initIterFrom (&r -> it, a, lo);
+  r -> hi = hi;
+}
+
+// Função que coloca em keys / infos os próximos (no máximo max) pares do intervalo e devolve quantos foram colocados (0 no fim)
+
+int nextBatch (IterRange *r, int keys[], int infos[], int max){
+  Tree a;
+  int n = 0;
+  while (n < max && r -> it.sp > 0){
+    a = r -> it.pilha[r -> it.sp - 1];
+    if (a -> key > r -> hi){
+      r -> it.sp = 0;   // todas as chaves que faltam são > hi
+      break;
+    }
+    nextIter (&r -> it, &keys[n], &infos[n]);
+    n++;
+  }
+  return n;
+}
+
+#ifdef AVL_ORDEM
+
+// Função auxiliar que devolve o nº de chaves < k (ou <= k, se incl)
+
+int rankAux (Tree a, int k, int incl){
+  int r = 0;
+  while (a != NULL)
+    if (k < a -> key || (k == a -> key && !incl)) a = a -> left;
+    else {
+      r += SIZE(a -> left) + 1;
+      a = a -> right;
+    }
+  return r;
+}
+
+// Função que devolve o nº de chaves < k
+
+int rankAVL (Tree a, int k){
+  return rankAux (a, k, 0);
+}
+
+// Função que devolve o nodo com a i-ésima menor chave, a contar de 0 (NULL se i estiver fora de [0, N - 1])
+
+Tree selectAVL (Tree a, int i){
+  int l;
+  while (a != NULL){
+    l = SIZE(a -> left);
+    if (i == l) break;
+    if (i < l) a = a -> left;
+    else {
+      i -= l + 1;
+      a = a -> right;
+    }
+  }
+  return a;
+}
+
+// Função que devolve o nº de chaves em [lo, hi]
+
+int countRangeAVL (Tree a, int lo, int hi){
+  if (lo > hi) return 0;
+  return rankAux (a, hi, 1) - rankAux (a, lo, 0);
+}
+
+// Função que inicia um iterador para as chaves <= hi a partir da i-ésima menor chave (paginação)
+
+void initRangeAt (IterRange *r, Tree a, int i, int hi){
+  Tree s = selectAVL (a, i);
+  if (s == NULL){
+    r -> it.sp = 0;
+    r -> it.rev = 0;
+  }
+  else initIterFrom (&r -> it, a, s -> key);
+  r -> hi = hi;
+}
+
+#endif
+
+/* Disposição de Eytzinger (AVL "congelada")
+   -> Numa fase só de leituras, procurar numa AVL é dominado pelas faltas de cache: cada nível é um nodo noutro sítio da memória.
+   -> freezeAVL copia as chaves para um array com a disposição de Eytzinger (a de uma heap): a raíz está na posição 1 e os filhos da
+posição k nas posições 2k e 2k + 1. Preenchendo-o por uma travessia inorder, obtemos uma árvore de procura completa, sem apontadores.
+      As informações ficam num array à parte, só consultado quando a chave é encontrada.
+   -> Procura (lower bound) sem saltos condicionais: k = 2k + (keys[k] < x), até sair do array. A resposta é o último nodo onde descemos
+para a esquerda, obtido retirando a k os bits 1 finais e mais um bit 0: k >> ffs(~k).
+   -> Os 16 descendentes 4 níveis abaixo de k ocupam as posições 16k .. 16k + 15, ou seja, uma linha de cache (de 64 bytes), que é pedida
+(prefetch) antes de ser precisa.
+   -> O array é alocado com tamanho 2^L (L o nº de níveis) e preenchido com INT_MAX, para o último nível poder ser lido sem testar os limites.
+*/
+
+typedef struct {
+  int n, niveis;
+  int *keys;    // keys[1 .. n], alinhado a 64 bytes
+  int *infos;
+} EytzAVL;
+
+// Função auxiliar que preenche a sub-árvore de Eytzinger com raíz em k pela ordem do iterador
+
+void freezeAux (EytzAVL *e, IterAVL *it, int k){
+  if (k <= e -> n){
+    freezeAux (e, it, 2 * k);
+    nextIter (it, &e -> keys[k], &e -> infos[k]);
+    freezeAux (e, it, 2 * k + 1);
+  }
+}
+
+// Função que exporta uma AVL para a disposição de Eytzinger (a AVL não é alterada)
+
+void freezeAVL (EytzAVL *e, Tree a){
+  IterAVL it;
+  int k, cap;
+  e -> n = 0;
+  for (initIter (&it, a); nextIter (&it, &k, &k); ) e -> n++;
+  for (e -> niveis = 0; (1 << e -> niveis) <= e -> n; e -> niveis++);
+  cap = (1 << e -> niveis) + 16;
+  e -> keys = aligned_alloc (64, ((cap * sizeof(int) + 63) / 64) * 64);
+  e -> infos = malloc (cap * sizeof(int));
+  for (k = 0; k < cap; k++) e -> keys[k] = INT_MAX;
+  initIter (&it, a);
+  freezeAux (e, &it, 1);
+}
+
+void freeEytz (EytzAVL *e){
+  free (e -> keys);
+  free (e -> infos);
+  e -> n = 0;
+}
+
+// Função que devolve a posição da menor chave >= x (0 se não existir)
+
+int lowerBoundEytz (EytzAVL *e, int x){
+  unsigned k = 1;
+  while (k <= (unsigned) e -> n){
+    __builtin_prefetch (e -> keys + 16 * k);
+    k = 2 * k + (e -> keys[k] < x);
+  }
+  return k >> __builtin_ffs (~k);
+}
+// A Complexidade desta função é dada por: T(N) = Theta(log N), com um único salto condicional (o do ciclo) por nível
+
+// Função que procura uma chave no array (devolve 1 e coloca a informação em *i se a chave existir)
+
+int lookupEytz (EytzAVL *e, int k, int *i){
+  int p = lowerBoundEytz (e, k);
+  if (p == 0 || e -> keys[p] != k) return 0;
+  *i = e -> infos[p];
+  return 1;
+}
+
+/* Procuras em lote
+   -> Uma procura isolada espera por uma falta de cache em cada nível. Avançando EYTZ_LOTE procuras ao mesmo tempo, um nível de cada vez,
+as faltas de cache das várias procuras sobrepõem-se;
+   -> Os primeiros L - 1 níveis estão completos, logo, todas as procuras dão exatamente L - 1 passos, sem testar os limites. No último nível,
+só avançam as posições k <= n (as outras já saíram da árvore).
+*/
+
+#define EYTZ_LOTE 16
+
+// Função que procura as nq chaves de qs, colocando em found[j] se qs[j] existe e em infos[j] a sua informação; devolve o nº de chaves encontradas
+
+int lookupBatchEytz (EytzAVL *e, const int qs[], int nq, int infos[], char found[]){
+  unsigned ks[EYTZ_LOTE], k;
+  int b, j, l, m, p, r = 0;
+  for (b = 0; b < nq; b += EYTZ_LOTE){
+    m = (nq - b < EYTZ_LOTE) ? nq - b : EYTZ_LOTE;
+    for (j = 0; j < m; j++) ks[j] = 1;
+    for (l = 1; l < e -> niveis; l++)
+      for (j = 0; j < m; j++){
+        k = ks[j];
+        __builtin_prefetch (e -> keys + 16 * k);
+        ks[j] = 2 * k + (e -> keys[k] < qs[b + j]);
+      }
+    for (j = 0; j < m; j++){
+      k = ks[j];
+      if (e -> n > 0) k = (k <= (unsigned) e -> n) ? 2 * k + (e -> keys[k] < qs[b + j]) : k;
+      p = k >> __builtin_ffs (~k);
+      found[b + j] = (p != 0 && e -> keys[p] == qs[b + j]);
+      if (found[b + j]){
+        infos[b + j] = e -> infos[p];
+        r++;
+      }
+    }
+  }
+  return r;
+}
+
+// Função que compara o débito (em procuras por segundo) da AVL, do array de Eytzinger e das procuras em lote, com nq chaves aleatórias em [0, maxK[
+
+void benchEytz (Tree a, int nq, int maxK){
+  EytzAVL e;
+  struct timespec t0, t1;
+  int *qs = malloc (nq * sizeof(int)), *infos = malloc (nq * sizeof(int)), j, i, c[3] = {0};
+  char *found = malloc (nq);
+  double t[3];
+  for (j = 0; j < nq; j++) qs[j] = rand () % maxK;
+  freezeAVL (&e, a);
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  for (j = 0; j < nq; j++) c[0] += lookupAVL (a, qs[j], &i);
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  t[0] = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  for (j = 0; j < nq; j++) c[1] += lookupEytz (&e, qs[j], &i);
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  t[1] = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  c[2] = lookupBatchEytz (&e, qs, nq, infos, found);
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  t[2] = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+  printf ("AVL: %.2fM/s  Eytzinger: %.2fM/s  lote: %.2fM/s  (encontradas: %d %d %d)\n",
+          nq / t[0] / 1e6, nq / t[1] / 1e6, nq / t[2] / 1e6, c[0], c[1], c[2]);
+  freeEytz (&e);
+  free (qs);
+  free (infos);
+  free (found);
+}
@@ -33,77 +33,1197 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
 
-#define EMPTY "-"
-#define DELETED "+"
+// Estado de uma posição (campo dist) no modo LINEAR
+#define EMPTY 0
+#define DELETED -1
 
+#define ALFA_MAX 0.75 // fator de carga máximo por omissão
+#define ALFA_MAX_CADEIAS 1.0 // fator de carga máximo por omissão no modo CADEIAS (comprimento médio das listas)
+#define ALFA_LIMITE 0.95 // maior alfaMax aceite com endereçamento aberto (com 1 a tabela podia encher e as inserções nunca terminavam)
+#define MIGRAR 4      // nº de posições da tabela antiga migradas em cada operação
+#define MIGRAR_RAPIDO (4 * MIGRAR) // nº de posições migradas quando é preciso redimensionar antes de a migração anterior terminar
+
+// Modos (motores) da tabela
+#define LINEAR 0      // linear probing com marcas EMPTY / DELETED
+#define ROBINHOOD 1   // Robin Hood hashing com remoção por backward-shift
+#define CADEIAS 2     // closed addressing: listas ligadas de pares
+
+#define KEY_INLINE 12       // chaves até KEY_INLINE bytes são guardadas no próprio par
+#define POOL_BLOCO (1 << 20) // tamanho dos blocos do pool de chaves longas
+#define POOL_MAX_BLOCOS (1 << 12) // nº máximo de blocos de um pool (as referências têm 12 bits para o bloco)
+#define POOL_LIMITE ((size_t) POOL_MAX_BLOCOS / 8 * POOL_BLOCO) // máximo de bytes de chaves longas (nas duas tabelas) de um HT
+
+/* Chaves
+    -> As chaves não têm tamanho fixo: cada par guarda o comprimento (len) da sua chave;
+    -> As chaves curtas (len <= KEY_INLINE) ficam dentro do próprio par, sem nenhum acesso extra à memória;
+    -> As chaves longas são copiadas para um pool (blocos de POOL_BLOCO bytes reservados de uma só vez) e o par guarda apenas a sua referência
+       (nº do bloco e posição dentro dele), o que mantém todos os pares com 32 bytes;
+    -> Como o bloco só tem 12 bits, uma inserção que levasse as chaves longas da tabela além de POOL_LIMITE falha (devolve -1). O limite tem margem
+       para os bytes de chaves removidas e para o espaço perdido no fim de cada bloco, logo, nenhum pool chega a precisar de POOL_MAX_BLOCOS blocos;
+    -> Cada par guarda também o hash completo da chave, logo:
+        > uma procura só compara os bytes da chave quando o hash e o comprimento coincidem;
+        > o redimensionamento não precisa de voltar a calcular o hash de nenhuma chave.
+*/
 struct pair {
-    char key[20];
+    uint64_t hash;    // hash completo da chave
+    unsigned len;     // comprimento da chave
     int value;
+    int dist;         // (LINEAR) EMPTY, DELETED ou 1 se está ocupada; (ROBINHOOD) 0 se está livre, senão 1 + distância à posição dada pela função de hash
+    union {
+        char curta[KEY_INLINE];  // chave curta (sem '\0')
+        uint32_t ref;            // chave longa: (bloco << 20) | posição no bloco
+    } key;
 };
 
 typedef struct {
-    int size;
-    int used;
-    struct pair *tbl;  
+    char **blocos;     // array de POOL_MAX_BLOCOS posições, reservado com o 1º bloco (nunca muda de sítio)
+    int nblocos;
+    int atual;         // bloco onde estão a ser copiadas as chaves
+    unsigned livre;    // 1ª posição livre do bloco atual
+    size_t bytes;      // bytes de chaves no pool
+    size_t lixo;       // bytes de chaves que já foram removidas da tabela
+} Pool;
+
+#define NOS_SLAB 256 // nº de nós reservados de cada vez no modo CADEIAS
+
+// Nó das listas ligadas do modo CADEIAS (o campo dist do par não é usado)
+struct no {
+    struct pair p;
+    struct no *prox;
+};
+
+/* Pool de nós
+    -> Os nós não são reservados um a um: reserva-se um slab de NOS_SLAB nós de cada vez;
+    -> Os nós removidos vão para uma lista de nós livres, que é usada antes de reservar um novo slab;
+    -> Os slabs só são libertados com a tabela.
+*/
+typedef struct {
+    struct no **slabs;
+    int nslabs, cap;
+    struct no *livres;
+} NoPool;
+
+/* Funções de hash
+    -> Uma função de hash recebe os bytes da chave e uma semente (seed) e devolve um valor de 64 bits;
+    -> A posição na tabela é obtida com uma máscara: como size é sempre uma potência de 2, (hash & (size - 1)) == (hash % size), mas sem a divisão.
+       Por isso, os bits de menor peso da função de hash têm de ser bem distribuídos.
+    -> Cada tabela usa uma semente aleatória, para que não seja possível escolher de antemão um conjunto de chaves que colidam todas.
+*/
+typedef uint64_t (*HashFn) (const char *key, size_t len, uint64_t seed);
+
+typedef struct ht {
+    int size;          // sempre uma potência de 2
+    int used;          // nº de chaves (nas duas tabelas, durante um redimensionamento)
+    int ocupadas;      // posições de tbl que não estão EMPTY (chaves e DELETED, pois ambos alongam as procuras)
+    float alfaMax;     // quando ocupadas / size ultrapassa alfaMax, a tabela é redimensionada (pode ser alterado depois do initHT, ver alfaMaxHT)
+    struct pair *tbl;
+    struct pair *old;  // tabela anterior, enquanto as suas chaves estão a ser migradas para tbl (NULL caso contrário)
+    int oldSize;
+    int migrar;        // próxima posição de old a migrar
+    Pool pool;         // chaves longas de tbl
+    Pool oldPool;      // chaves longas de old (libertado quando a migração termina)
+    struct no **cad;   // (CADEIAS) listas de tbl
+    struct no **oldCad;// (CADEIAS) listas de old
+    NoPool nos;        // (CADEIAS) nós das listas
+    HashFn hashf;
+    uint64_t seed;
+    int modo;          // LINEAR, ROBINHOOD ou CADEIAS
 } HT;
 
-// Exemplo de uma função de hash
-int hash (char key[], int size){
-    int i = 0, sum = 0;
-    while (key[i] != '\0') sum += key[i++];
-    return (sum % size);
+/* Redimensionamento incremental
+    -> Quando o fator de carga atinge alfaMax, reserva-se uma nova tabela mas a antiga não é logo despejada (isso custaria O(n) numa só inserção);
+    -> As duas tabelas coexistem: as novas chaves vão para a tabela nova e cada operação migra MIGRAR posições da antiga;
+    -> As procuras consultam a tabela nova e, se ainda existir, a antiga.
+    Como a tabela nova tem o dobro do tamanho, a migração termina muito antes de esta atingir alfaMax, logo, nenhuma operação custa mais do que
+O(MIGRAR) além da própria procura.
+    Se for preciso redimensionar outra vez antes de a migração terminar (p.e. muitas chaves longas removidas), essa operação migra MIGRAR_RAPIDO
+posições em vez de despejar o resto da tabela antiga, e o redimensionamento fica para a primeira operação depois de a migração terminar.
+Entretanto a tabela nova não enche: mesmo que todas as operações até lá sejam inserções, fica abaixo de alfaMax / 2 + 1/2 < 1 (ver ALFA_LIMITE).
+*/
+
+/* Robin Hood hashing
+    -> Continua a ser open addressing com linear probing, mas cada posição guarda a distância (dist) a que a sua chave está da posição "ideal";
+    -> Na inserção, se a chave a inserir já está mais longe da sua posição ideal do que a chave que ocupa a posição atual, trocam de lugar
+       ("tira-se aos ricos para dar aos pobres"), o que torna as distâncias muito mais uniformes;
+    -> Na procura, podemos parar assim que encontrarmos uma posição com dist menor do que a distância percorrida (a chave já lá estaria);
+    -> Na remoção não se usa DELETED: as chaves seguintes do cluster recuam uma posição (backward-shift), logo, não há marcas a alongar procuras.
+    -> A posição livre é reconhecida por dist == 0.
+*/
+
+// Exemplo de uma função de hash (soma dos caracteres): anagramas e chaves curtas colidem quase todas, o que gera os clusters referidos acima
+uint64_t hashSoma (const char *key, size_t len, uint64_t seed){
+    uint64_t sum = 0;
+    size_t i;
+    (void) seed;
+    for (i = 0; i < len; i++) sum += (unsigned char) key[i];
+    return sum;
 }
 
-// Função para iniciar uma tabela de hash
-void initHT (HT *h, int size){
+// Funções auxiliares para as funções de hash seguintes
+static inline uint64_t read64 (const char *p){
+    uint64_t r;
+    memcpy (&r, p, 8);
+    return r;
+}
+
+static inline uint64_t read32 (const char *p){
+    uint32_t r;
+    memcpy (&r, p, 4);
+    return r;
+}
+
+static inline uint32_t rotl32 (uint32_t x, int r){
+    return (x << r) | (x >> (32 - r));
+}
+
+// Multiplicação de 64 x 64 bits, devolvendo a "mistura" (xor) das metades alta e baixa do resultado de 128 bits
+static inline uint64_t mum (uint64_t a, uint64_t b){
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t) a * b;
+    return (uint64_t) r ^ (uint64_t) (r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl, lo = t + (rm1 << 32);
+    c += lo < t;
+    return lo ^ (rh + (rm0 >> 32) + (rm1 >> 32) + c);
+#endif
+}
+
+#define P0 0xa0761d6478bd642fULL
+#define P1 0xe7037ed1a0b428dbULL
+#define P2 0x8ebc6af09c88c6e3ULL
+
+// Função de hash de 64 bits (ao estilo do wyhash): lê a chave 16 bytes de cada vez e mistura-os com multiplicações de 128 bits
+uint64_t hash64 (const char *key, size_t len, uint64_t seed){
+    const char *p = key;
+    size_t i = len;
+    uint64_t a, b;
+    seed ^= P0;
+    for (; i > 16; i -= 16, p += 16)
+        seed = mum (read64 (p) ^ P1, read64 (p + 8) ^ seed);
+    if (i >= 8){            // os dois blocos de 8 bytes podem sobrepor-se
+        a = read64 (p);
+        b = read64 (p + i - 8);
+    }
+    else if (i >= 4){
+        a = read32 (p);
+        b = read32 (p + i - 4);
+    }
+    else if (i > 0){
+        a = ((uint64_t) (unsigned char) p[0] << 16) | ((uint64_t) (unsigned char) p[i >> 1] << 8) | (unsigned char) p[i - 1];
+        b = 0;
+    }
+    else a = b = 0;
+    return mum (P1 ^ len, mum (a ^ P2, b ^ seed));
+}
+
+// Função de hash de 32 bits (ao estilo do MurmurHash3), para máquinas sem multiplicação rápida de 64 bits
+uint64_t hash32 (const char *key, size_t len, uint64_t seed){
+    uint32_t h = (uint32_t) seed ^ (uint32_t) len, k;
+    size_t i;
+    for (i = 0; i + 4 <= len; i += 4){
+        k = (uint32_t) read32 (key + i) * 0xcc9e2d51;
+        h ^= rotl32 (k, 15) * 0x1b873593;
+        h = rotl32 (h, 13) * 5 + 0xe6546b64;
+    }
+    for (k = 0; i < len; i++) k = (k << 8) | (unsigned char) key[i];
+    k *= 0xcc9e2d51;
+    h ^= rotl32 (k, 15) * 0x1b873593;
+    // finalização: espalha todos os bits de h por todos os bits do resultado
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+// Função que gera uma semente aleatória para uma tabela
+uint64_t randomSeed (void *h){
+    static uint64_t contador = 0;
+    uint64_t x = (uint64_t) time (NULL) ^ ((uint64_t) clock () << 32) ^ (uint64_t) (uintptr_t) h ^ (++contador * P1);
+    return mum (x ^ P0, x ^ P2);
+}
+
+// Funções do pool de chaves longas
+void initPool (Pool *p){
+    p -> blocos = NULL;
+    p -> nblocos = 0;
+    p -> atual = -1;
+    p -> livre = POOL_BLOCO;
+    p -> bytes = p -> lixo = 0;
+}
+
+void destroyPool (Pool *p){
+    int i;
+    for (i = 0; i < p -> nblocos; i++) free (p -> blocos[i]);
+    free (p -> blocos);
+}
+
+// Função auxiliar que acrescenta um bloco com n bytes ao pool e devolve o seu número
+int newBloco (Pool *p, size_t n){
+    if (p -> blocos == NULL) p -> blocos = malloc (POOL_MAX_BLOCOS * sizeof(char *));
+    if (p -> nblocos == POOL_MAX_BLOCOS){ // não deve acontecer (ver POOL_LIMITE): as referências passariam a apontar para outros blocos
+        fprintf (stderr, "newBloco: pool com %d blocos\n", POOL_MAX_BLOCOS);
+        abort ();
+    }
+    p -> blocos[p -> nblocos] = malloc (n);
+    return p -> nblocos++;
+}
+
+// Função que copia uma chave para o pool e devolve a sua referência
+uint32_t poolAdd (Pool *p, const char *key, unsigned len){
+    int b;
+    uint32_t r;
+    p -> bytes += len;
+    if (len > POOL_BLOCO){              // chave maior do que um bloco: fica num bloco só para ela
+        b = newBloco (p, len);
+        memcpy (p -> blocos[b], key, len);
+        return ((uint32_t) b << 20);
+    }
+    if (p -> livre + len > POOL_BLOCO){
+        p -> atual = newBloco (p, POOL_BLOCO);
+        p -> livre = 0;
+    }
+    r = ((uint32_t) p -> atual << 20) | p -> livre;
+    memcpy (p -> blocos[p -> atual] + p -> livre, key, len);
+    p -> livre += len;
+    return r;
+}
+
+static inline char *poolGet (Pool *p, uint32_t ref){
+    return (p -> blocos[ref >> 20] + (ref & (POOL_BLOCO - 1)));
+}
+
+// Função que devolve os bytes da chave de um par
+static inline const char *pairKey (Pool *p, struct pair *s){
+    return (s -> len <= KEY_INLINE ? s -> key.curta : poolGet (p, s -> key.ref));
+}
+
+// Função que testa se o par s tem a chave key (com comprimento len e hash hv), só comparando os bytes se o hash e o comprimento coincidirem
+static inline int sameKey (Pool *p, struct pair *s, const char *key, unsigned len, uint64_t hv){
+    return (s -> hash == hv && s -> len == len && memcmp (pairKey (p, s), key, len) == 0);
+}
+
+// Função auxiliar que preenche um par (a chave longa é copiada para o pool p)
+void setPair (Pool *p, struct pair *s, const char *key, unsigned len, int value, uint64_t hv){
+    s -> hash = hv;
+    s -> len = len;
+    s -> value = value;
+    if (len <= KEY_INLINE) memcpy (s -> key.curta, key, len);
+    else s -> key.ref = poolAdd (p, key, len);
+}
+
+// Funções do pool de nós
+void initNoPool (NoPool *p){
+    p -> slabs = NULL;
+    p -> nslabs = p -> cap = 0;
+    p -> livres = NULL;
+}
+
+void destroyNoPool (NoPool *p){
     int i;
-    h -> tbl = calloc (size, sizeof(struct pair));
-    h -> size = size;
+    for (i = 0; i < p -> nslabs; i++) free (p -> slabs[i]);
+    free (p -> slabs);
+}
+
+struct no *allocNo (NoPool *p){
+    struct no *n;
+    int i;
+    if (p -> livres == NULL){
+        if (p -> nslabs == p -> cap){
+            p -> cap = p -> cap ? 2 * p -> cap : 8;
+            p -> slabs = realloc (p -> slabs, p -> cap * sizeof(struct no *));
+        }
+        n = p -> slabs[p -> nslabs++] = malloc (NOS_SLAB * sizeof(struct no));
+        for (i = 0; i < NOS_SLAB; i++){
+            n[i].prox = p -> livres;
+            p -> livres = &n[i];
+        }
+    }
+    n = p -> livres;
+    p -> livres = n -> prox;
+    return n;
+}
+
+void freeNo (NoPool *p, struct no *n){
+    n -> prox = p -> livres;
+    p -> livres = n;
+}
+
+// Função que calcula o hash de uma chave com a função e a semente da tabela
+uint64_t hashHT (HT *h, const char *key, unsigned len){
+    return h -> hashf (key, len, h -> seed);
+}
+
+// Função auxiliar que reserva uma tabela com todas as posições EMPTY
+struct pair *newTbl (int size){
+    return calloc (size, sizeof(struct pair));
+}
+
+// Função para iniciar uma tabela de hash com um dado modo, função de hash e semente
+void initHTHash (HT *h, int size, int modo, HashFn f, uint64_t seed){
+    int cap = 1;
+    while (cap < size) cap *= 2; // arredondar para uma potência de 2
+    h -> tbl = (modo == CADEIAS ? NULL : newTbl (cap));
+    h -> cad = (modo == CADEIAS ? calloc (cap, sizeof(struct no *)) : NULL);
+    h -> size = cap;
+    h -> hashf = f;
+    h -> seed = seed;
+    h -> modo = modo;
     h -> used = 0;
-    for (i = 0; i < h -> size; i++) strcpy(h -> tbl[i].key, EMPTY);
+    h -> ocupadas = 0;
+    h -> alfaMax = (modo == CADEIAS ? ALFA_MAX_CADEIAS : ALFA_MAX);
+    h -> old = NULL;
+    h -> oldCad = NULL;
+    h -> oldSize = h -> migrar = 0;
+    initPool (&h -> pool);
+    initPool (&h -> oldPool);
+    initNoPool (&h -> nos);
+}
+
+// Função para iniciar uma tabela de hash num dado modo (com hash64 e uma semente aleatória)
+void initHTModo (HT *h, int size, int modo){
+    initHTHash (h, size, modo, hash64, 0);
+    h -> seed = randomSeed (h);
+}
+
+// Função para iniciar uma tabela de hash
+void initHT (HT *h, int size){
+    initHTModo (h, size, LINEAR);
+}
+
+// Função auxiliar que liberta os blocos de um pool que deixou de pertencer à tabela (durante o redimensionamento) e o deixa vazio
+void releasePool (Pool *p){
+    destroyPool (p);
+    initPool (p);
+}
+
+// Função para libertar a memória de uma tabela de hash
+void destroyHT (HT *h){
+    free (h -> tbl);
+    free (h -> old);
+    free (h -> cad);
+    free (h -> oldCad);
+    destroyPool (&h -> pool);
+    destroyPool (&h -> oldPool);
+    destroyNoPool (&h -> nos);
 }
 
 // Função para libertar um elemento de uma tabela de hash
 int freeHT (HT *h, int k){
-    if (strcmp((h -> tbl)[k].key, EMPTY) == 0) return 1;
-    if (strcmp((h -> tbl)[k].key, DELETED) == 0) return 1;
-    return 0;
+    return ((h -> tbl)[k].dist != 1);   // EMPTY ou DELETED
 }
 
-// Função para inserir elementos a uma tabela de hash
-int writeHT (HT *h, char key[], int value){
-    float load = h -> used / h -> size;
-    int i = hash(key, h -> size);
+// Função auxiliar que procura uma chave (com hash hv) numa tabela (devolve a posição ou -1)
+int lookupTbl (struct pair *t, int size, Pool *p, const char *key, unsigned len, uint64_t hv){
+    int i, ii;
+    i = ii = hv & (size - 1);
+    while(t[i].dist != 1 || !sameKey (p, &t[i], key, len, hv)){
+        if (t[i].dist == EMPTY) return -1;
+        i = (i + 1) & (size - 1);
+        if (i == ii) return -1;
+    }
+    return i;
+}
+
+// Função auxiliar que coloca um par na primeira posição livre de tbl (a chave não pode estar em tbl)
+int placeHT (HT *h, struct pair *s){
+    int i = s -> hash & (h -> size - 1);
     while (!freeHT(h, i)){
-        i = (i + 1) % (h -> size);
+        i = (i + 1) & (h -> size - 1);
     }
-    strcpy((h -> tbl)[i].key, key);
-    (h -> tbl)[i].value = value;
-    h -> used++;
+    if ((h -> tbl)[i].dist == EMPTY) h -> ocupadas++;
+    (h -> tbl)[i] = *s;
+    (h -> tbl)[i].dist = 1;
     return i;
 }
 
+// (ROBINHOOD) Função auxiliar que procura uma chave numa tabela (devolve a posição ou -1)
+int lookupRH (struct pair *t, int size, Pool *p, const char *key, unsigned len, uint64_t hv){
+    int i = hv & (size - 1), d = 1;
+    while (t[i].dist >= d){     // uma posição livre (dist == 0) ou "mais rica" termina a procura
+        if (sameKey (p, &t[i], key, len, hv)) return i;
+        i = (i + 1) & (size - 1);
+        d++;
+    }
+    return -1;
+}
+
+// (ROBINHOOD) Função auxiliar que coloca um par em tbl (a chave não pode estar em tbl)
+int placeRH (HT *h, struct pair *s){
+    struct pair cur = *s, tmp;
+    int i = cur.hash & (h -> size - 1), r = -1;
+    cur.dist = 1;
+    while ((h -> tbl)[i].dist != 0){
+        if ((h -> tbl)[i].dist < cur.dist){ // a chave da posição i está mais perto da sua posição ideal: troca
+            tmp = (h -> tbl)[i];
+            (h -> tbl)[i] = cur;
+            cur = tmp;
+            if (r < 0) r = i;
+        }
+        i = (i + 1) & (h -> size - 1);
+        cur.dist++;
+    }
+    (h -> tbl)[i] = cur;
+    h -> ocupadas++;
+    return (r < 0 ? i : r);
+}
+
+// (ROBINHOOD) Função auxiliar que remove a posição i de uma tabela, recuando as chaves seguintes do cluster
+void removeRH (struct pair *t, int size, int i){
+    int j = (i + 1) & (size - 1);
+    while (t[j].dist > 1){
+        t[i] = t[j];
+        t[i].dist--;
+        i = j;
+        j = (j + 1) & (size - 1);
+    }
+    t[i].dist = 0;
+}
+
+// Funções auxiliares que escolhem o motor de acordo com o modo da tabela
+int lookupHT (HT *h, struct pair *t, int size, Pool *p, const char *key, unsigned len, uint64_t hv){
+    return (h -> modo == ROBINHOOD ? lookupRH (t, size, p, key, len, hv) : lookupTbl (t, size, p, key, len, hv));
+}
+
+// coloca em tbl o par s (cuja chave longa, se existir, já está em h -> pool)
+int insertHT (HT *h, struct pair *s){
+    return (h -> modo == ROBINHOOD ? placeRH (h, s) : placeHT (h, s));
+}
+
+// remove a chave da posição i da tabela t (tbl ou old), cujas chaves longas estão no pool p
+void removeHT (HT *h, struct pair *t, int size, Pool *p, int i){
+    if (t[i].len > KEY_INLINE) p -> lixo += t[i].len;
+    if (h -> modo == ROBINHOOD){
+        removeRH (t, size, i);
+        if (t == h -> tbl) h -> ocupadas--;
+    }
+    else t[i].dist = DELETED;
+}
+
+// testa se a posição i da tabela t tem uma chave
+int usedSlot (HT *h, struct pair *t, int i){
+    return (h -> modo == ROBINHOOD ? t[i].dist != 0 : t[i].dist == 1);
+}
+
+// Função auxiliar que testa se acrescentar uma chave de len bytes levaria as chaves longas de h além de POOL_LIMITE
+// (uma chave que passa da tabela antiga para a nova não acrescenta bytes vivos, logo, nunca falha)
+int poolCheio (HT *h, unsigned len, int mover){
+    size_t vivos = h -> pool.bytes - h -> pool.lixo;
+    if (len <= KEY_INLINE || mover) return 0;
+    if (h -> old != NULL || h -> oldCad != NULL) vivos += h -> oldPool.bytes - h -> oldPool.lixo;
+    return (vivos + len > POOL_LIMITE);
+}
+
+// Função auxiliar que devolve o alfaMax efetivo: valores <= 0 passam ao valor por omissão e, com endereçamento aberto,
+// valores acima de ALFA_LIMITE passam a ALFA_LIMITE, para que a tabela tenha sempre posições EMPTY
+float alfaMaxHT (HT *h){
+    if (h -> modo == CADEIAS) return (h -> alfaMax > 0 ? h -> alfaMax : ALFA_MAX_CADEIAS);
+    if (h -> alfaMax <= 0) return ALFA_MAX;
+    return (h -> alfaMax < ALFA_LIMITE ? h -> alfaMax : ALFA_LIMITE);
+}
+
+// Função auxiliar que testa se a tabela deve ser redimensionada: pela carga ou, quando mais de metade dos bytes do pool são de chaves
+// removidas, para "limpar" o pool
+int precisaResize (HT *h){
+    return (h -> ocupadas + 1 > alfaMaxHT (h) * h -> size || (h -> pool.lixo > POOL_BLOCO && 2 * h -> pool.lixo > h -> pool.bytes));
+}
+
+// Função auxiliar que migra até n posições da tabela antiga para a nova
+void migrateHT (HT *h, int n){
+    struct pair s, *p;
+    for (; h -> old != NULL && n > 0; n--){
+        if (usedSlot (h, h -> old, h -> migrar)){
+            // o hash está guardado no par, logo, só as chaves longas precisam de ser copiadas (para o pool da tabela nova)
+            s = (h -> old)[h -> migrar];
+            if (s.len > KEY_INLINE) s.key.ref = poolAdd (&h -> pool, poolGet (&h -> oldPool, s.key.ref), s.len);
+            insertHT (h, &s);
+            // a cópia antiga deixa de ser encontrada pelas procuras
+            // (em ROBINHOOD a posição pode receber a chave seguinte do cluster, logo, só avançamos quando ficar livre)
+            removeHT (h, h -> old, h -> oldSize, &h -> oldPool, h -> migrar);
+            if (h -> modo == ROBINHOOD) continue;
+        }
+        if (++(h -> migrar) == h -> oldSize){
+            p = h -> old;
+            h -> old = NULL;
+            free (p);
+            releasePool (&h -> oldPool);  // as chaves removidas entretanto desaparecem com o pool antigo
+        }
+    }
+}
+
+// Função auxiliar que inicia o redimensionamento (requer h -> old == NULL, isto é, a migração anterior terminada)
+void resizeHT (HT *h){
+    h -> old = h -> tbl;
+    h -> oldSize = h -> size;
+    h -> oldPool = h -> pool;
+    initPool (&h -> pool);
+    h -> migrar = 0;
+    // se a carga se deve sobretudo a posições DELETED (ou a chaves removidas do pool), basta reconstruir a tabela com o mesmo tamanho
+    if (h -> used + 1 > alfaMaxHT (h) * h -> size / 2) h -> size *= 2;
+    h -> tbl = newTbl (h -> size);
+    h -> ocupadas = 0;
+}
+
+/* Closed addressing (modo CADEIAS)
+    -> Cada posição de cad é uma lista ligada com os pares cujo hash dá essa posição;
+    -> O redimensionamento também é incremental (migram-se MIGRAR listas por operação), mas os nós não são copiados:
+       cada nó é simplesmente religado à lista correspondente na tabela nova;
+    -> A remoção devolve o nó ao pool, logo, não há marcas DELETED a degradar as procuras seguintes.
+*/
+
+// Função auxiliar que devolve o endereço do apontador para o nó com a chave dada (se a chave não existir, esse apontador é NULL)
+struct no **findCH (struct no **t, int size, Pool *p, const char *key, unsigned len, uint64_t hv){
+    struct no **l = &t[hv & (size - 1)];
+    while (*l != NULL && !sameKey (p, &(*l) -> p, key, len, hv)) l = &(*l) -> prox;
+    return l;
+}
+
+// Função auxiliar que acrescenta o nó n às listas de cad
+void linkCH (HT *h, struct no *n){
+    struct no **l = &(h -> cad)[n -> p.hash & (h -> size - 1)];
+    n -> prox = *l;
+    *l = n;
+    h -> ocupadas++;
+}
+
+// Função auxiliar que remove o nó *l das listas (cujas chaves longas estão no pool p)
+void unlinkCH (HT *h, struct no **l, Pool *p){
+    struct no *n = *l;
+    if (n -> p.len > KEY_INLINE) p -> lixo += n -> p.len;
+    *l = n -> prox;
+    freeNo (&h -> nos, n);
+}
+
+// Função auxiliar que migra até n listas da tabela antiga para a nova, reaproveitando os nós
+void migrateCH (HT *h, int n){
+    struct no *x, *t, **c;
+    for (; h -> oldCad != NULL && n > 0; n--){
+        for (x = (h -> oldCad)[h -> migrar]; x != NULL; x = t){
+            t = x -> prox;
+            if (x -> p.len > KEY_INLINE){
+                x -> p.key.ref = poolAdd (&h -> pool, poolGet (&h -> oldPool, x -> p.key.ref), x -> p.len);
+                h -> oldPool.lixo += x -> p.len;
+            }
+            linkCH (h, x);
+        }
+        (h -> oldCad)[h -> migrar] = NULL;
+        if (++(h -> migrar) == h -> oldSize){
+            c = h -> oldCad;
+            h -> oldCad = NULL;
+            free (c);
+            releasePool (&h -> oldPool);
+        }
+    }
+}
+
+// Função auxiliar que inicia o redimensionamento (requer h -> oldCad == NULL, isto é, a migração anterior terminada)
+void resizeCH (HT *h){
+    h -> oldCad = h -> cad;
+    h -> oldSize = h -> size;
+    h -> oldPool = h -> pool;
+    initPool (&h -> pool);
+    h -> migrar = 0;
+    if (h -> used + 1 > alfaMaxHT (h) * h -> size) h -> size *= 2;
+    h -> cad = calloc (h -> size, sizeof(struct no *));
+    h -> ocupadas = 0;
+}
+
+int writeCH (HT *h, const char *key, unsigned len, int value, uint64_t hv){
+    struct no **l, *n;
+    migrateCH (h, MIGRAR);
+    if (*(l = findCH (h -> cad, h -> size, &h -> pool, key, len, hv)) != NULL){
+        (*l) -> p.value = value;
+        return (hv & (h -> size - 1));
+    }
+    l = (h -> oldCad != NULL ? findCH (h -> oldCad, h -> oldSize, &h -> oldPool, key, len, hv) : NULL);
+    if (l != NULL && *l == NULL) l = NULL;   // a chave não está na tabela antiga
+    if (poolCheio (h, len, l != NULL)) return -1;
+    if (l != NULL)
+        unlinkCH (h, l, &h -> oldPool); // a chave passa para a tabela nova
+    else
+        h -> used++;
+    if (precisaResize (h)){
+        migrateCH (h, MIGRAR_RAPIDO);   // migração pendente: é acelerada, não despejada de uma vez
+        if (h -> oldCad == NULL) resizeCH (h);
+    }
+    n = allocNo (&h -> nos);
+    setPair (&h -> pool, &n -> p, key, len, value, hv);
+    linkCH (h, n);
+    return (hv & (h -> size - 1));
+}
+
+int readCH (HT *h, const char *key, unsigned len, int *value, uint64_t hv){
+    struct no **l;
+    migrateCH (h, MIGRAR);
+    if (*(l = findCH (h -> cad, h -> size, &h -> pool, key, len, hv)) != NULL){
+        *value = (*l) -> p.value;
+        return (hv & (h -> size - 1));
+    }
+    if (h -> oldCad != NULL && *(l = findCH (h -> oldCad, h -> oldSize, &h -> oldPool, key, len, hv)) != NULL){
+        *value = (*l) -> p.value;
+        return (hv & (h -> oldSize - 1));
+    }
+    return -1;
+}
+
+int deleteCH (HT *h, const char *key, unsigned len, uint64_t hv){
+    struct no **l;
+    int r = -1;
+    migrateCH (h, MIGRAR);
+    if (*(l = findCH (h -> cad, h -> size, &h -> pool, key, len, hv)) != NULL){
+        unlinkCH (h, l, &h -> pool);
+        h -> ocupadas--;
+        r = hv & (h -> size - 1);
+    }
+    else if (h -> oldCad != NULL && *(l = findCH (h -> oldCad, h -> oldSize, &h -> oldPool, key, len, hv)) != NULL){
+        unlinkCH (h, l, &h -> oldPool);
+        r = hv & (h -> oldSize - 1);
+    }
+    if (r >= 0) h -> used--;
+    return r;
+}
+
+// Função auxiliar que insere (ou altera) a chave key, com comprimento len e hash hv
+int writeHV (HT *h, const char *key, unsigned len, uint64_t hv, int value){
+    int i;
+    struct pair s;
+    if (h -> modo == CADEIAS) return writeCH (h, key, len, value, hv);
+    migrateHT (h, MIGRAR);
+    i = lookupHT (h, h -> tbl, h -> size, &h -> pool, key, len, hv);
+    if (i >= 0){
+        (h -> tbl)[i].value = value;
+        return i;
+    }
+    if (h -> old != NULL) i = lookupHT (h, h -> old, h -> oldSize, &h -> oldPool, key, len, hv);
+    if (poolCheio (h, len, i >= 0)) return -1;
+    if (i >= 0)
+        removeHT (h, h -> old, h -> oldSize, &h -> oldPool, i); // a chave passa para a tabela nova
+    else
+        h -> used++;
+    if (precisaResize (h)){
+        migrateHT (h, MIGRAR_RAPIDO);   // migração pendente: é acelerada, não despejada de uma vez
+        if (h -> old == NULL) resizeHT (h);
+    }
+    setPair (&h -> pool, &s, key, len, value, hv);
+    return insertHT (h, &s);
+}
+
+// Função para inserir (ou alterar) elementos numa tabela de hash (devolve -1 se a chave não couber no pool, ver POOL_LIMITE)
+int writeHT (HT *h, char key[], int value){
+    unsigned len = strlen (key);
+    return writeHV (h, key, len, hashHT (h, key, len), value);
+}
+
 // Função para ler elementos de uma tabela de hash
 int readHT (HT *h, char key[], int * value){
-    int i, ii;
-    i = ii = hash(key, h -> size);
-    while(strcmp((h -> tbl)[i].key, key) != 0){
-        if (strcmp ((h -> tbl)[i].key, EMPTY) == 0) return -1;
-        i = (i + 1) % (h -> size);
-        if (i == ii) return -1;
+    int i;
+    unsigned len = strlen (key);
+    uint64_t hv = hashHT (h, key, len);
+    if (h -> modo == CADEIAS) return readCH (h, key, len, value, hv);
+    migrateHT (h, MIGRAR);
+    if ((i = lookupHT (h, h -> tbl, h -> size, &h -> pool, key, len, hv)) >= 0){
+        *value = (h -> tbl)[i].value;
+        return i;
     }
-    *value = (h -> tbl)[i].value;
-    return i;
+    if (h -> old != NULL && (i = lookupHT (h, h -> old, h -> oldSize, &h -> oldPool, key, len, hv)) >= 0){
+        *value = (h -> old)[i].value;
+        return i;
+    }
+    return -1;
+}
+
+// Função auxiliar que remove a chave key, com comprimento len e hash hv
+int deleteHV (HT *h, const char *key, unsigned len, uint64_t hv){
+    int r;
+    if (h -> modo == CADEIAS) return deleteCH (h, key, len, hv);
+    migrateHT (h, MIGRAR);
+    if ((r = lookupHT (h, h -> tbl, h -> size, &h -> pool, key, len, hv)) >= 0)
+        removeHT (h, h -> tbl, h -> size, &h -> pool, r);
+    else if (h -> old != NULL && (r = lookupHT (h, h -> old, h -> oldSize, &h -> oldPool, key, len, hv)) >= 0)
+        removeHT (h, h -> old, h -> oldSize, &h -> oldPool, r);
+    if (r >= 0) h -> used--;
+    return r;
 }
 
 // Função que elimina uma tabela de hash
 int deleteHT (HT *h, char key[]){
-    int r, v;
-    r = readHT (h, key, &v);
-    if (r >= 0){
-        strcpy ((h -> tbl)[r].key, DELETED);
-        h -> used--;
+    unsigned len = strlen (key);
+    return deleteHV (h, key, len, hashHT (h, key, len));
+}
+
+/* Comprimento das procuras
+    O custo de uma procura com sucesso é o nº de posições visitadas desde a posição dada pela função de hash até à posição da chave
+(no modo CADEIAS, o nº de nós visitados na lista).
+    A função seguinte calcula a distribuição desse comprimento para todas as chaves da tabela (hist[i] = nº de chaves encontradas ao fim de i + 1
+posições, sendo a última posição do histograma partilhada por todos os comprimentos >= n), o que permite comparar funções de hash
+(p.e. hashSoma e hash64) sobre o mesmo conjunto de chaves.
+*/
+
+// Função que preenche o histograma dos comprimentos de procura e devolve o comprimento máximo
+int probeStatsHT (HT *h, int hist[], int n){
+    int i, d, max = 0;
+    struct no *x;
+    for (i = 0; i < n; i++) hist[i] = 0;
+    if (h -> modo == CADEIAS){
+        for (i = 0; i < h -> size; i++)
+            for (x = (h -> cad)[i], d = 0; x != NULL; x = x -> prox, d++){
+                hist[d < n ? d : n - 1]++;
+                if (d + 1 > max) max = d + 1;
+            }
+        return max;
+    }
+    for (i = 0; i < h -> size; i++)
+        if (usedSlot (h, h -> tbl, i)){
+            d = (i - (int) ((h -> tbl)[i].hash & (h -> size - 1))) & (h -> size - 1);
+            hist[d < n ? d : n - 1]++;
+            if (d + 1 > max) max = d + 1;
+        }
+    return max;
+}
+
+// Função que calcula o fator de carga (alfa) da tabela: no modo CADEIAS é o comprimento médio das listas
+float alfaHT (HT *h){
+    return ((float) h -> used / h -> size);
+}
+
+/* Benchmark dos comprimentos de procura
+    benchProbesHT insere os mesmos conjuntos de nChaves chaves ("userN" sequenciais, números "N" e cadeias aleatórias de 8 letras) em tabelas
+LINEAR com hashSoma, hash32 e hash64 (mesma semente) e mostra, para cada par, o comprimento médio e máximo das procuras dado por probeStatsHT.
+*/
+
+// Função auxiliar que escreve em key a i-ésima chave do conjunto c
+void chaveBench (char key[], int c, int i){
+    int j;
+    uint64_t x;
+    if (c == 0) sprintf (key, "user%d", i);
+    else if (c == 1) sprintf (key, "%d", i);
+    else {
+        x = P2 * (i + 1);
+        for (j = 0; j < 8; j++, x /= 26) key[j] = 'a' + x % 26;
+        key[8] = '\0';
+    }
+}
+
+void benchProbesHT (int nChaves){
+    HashFn fs[] = {hashSoma, hash32, hash64};
+    char *nomesF[] = {"hashSoma", "hash32", "hash64"}, *nomesC[] = {"userN", "N", "aleatorias"};
+    char key[24];
+    int c, f, i, max, *hist;
+    double soma;
+    HT h;
+    for (c = 0; c < 3; c++)
+        for (f = 0; f < 3; f++){
+            initHTHash (&h, 16, LINEAR, fs[f], P1);
+            for (i = 0; i < nChaves; i++){
+                chaveBench (key, c, i);
+                writeHT (&h, key, i);
+            }
+            migrateHT (&h, 2 * h.oldSize); // terminar a migração, para que todas as chaves estejam em tbl
+            hist = malloc (h.size * sizeof(int));
+            max = probeStatsHT (&h, hist, h.size);
+            for (i = 0, soma = 0; i < h.size; i++) soma += (double) hist[i] * (i + 1);
+            printf ("%-10s %-8s alfa %.2f: media %.2f, maximo %d\n", nomesC[c], nomesF[f], alfaHT (&h), soma / h.used, max);
+            free (hist);
+            destroyHT (&h);
+        }
+}
+
+// (CADEIAS) Função que preenche o histograma dos comprimentos das listas (hist[i] = nº de listas com i nós) e devolve o comprimento máximo
+int chainStatsHT (HT *h, int hist[], int n){
+    int i, c, max = 0;
+    struct no *x;
+    for (i = 0; i < n; i++) hist[i] = 0;
+    for (i = 0; h -> modo == CADEIAS && i < h -> size; i++){
+        for (x = (h -> cad)[i], c = 0; x != NULL; x = x -> prox) c++;
+        hist[c < n ? c : n - 1]++;
+        if (c > max) max = c;
     }
+    return max;
+}
+
+/* Tabela de hash concorrente (CHT)
+    -> A tabela é dividida em shards (potência de 2); o shard de uma chave é dado pelos bits de maior peso do hash (hash64, com a semente da
+       tabela) e a posição dentro do shard pelos de menor peso;
+    -> Cada shard é uma tabela de endereçamento aberto (linear probing) de apontadores para entradas imutáveis (hash, valor e bytes da chave):
+        > alterar o valor de uma chave é criar uma entrada nova e trocar o apontador da sua posição; remover é trocá-lo pela marca CHT_APAGADA;
+        > uma posição nunca volta a NULL e as entradas nunca mudam de posição, logo, cada posição lida por um leitor está antes ou depois de uma
+          escrita, mas nunca a meio;
+        > o redimensionamento copia os apontadores (não as entradas) para uma tabela nova, que é publicada com uma só escrita atómica. Não é
+          incremental como o do HT (custa O(n / nshards) ao escritor que o faz), mas os leitores que ainda estejam na tabela antiga não são
+          afetados: veem o shard tal como estava no momento da troca.
+    -> Escritores (writeCHT, deleteCHT): exclusão mútua por shard. O lock fica numa linha de cache diferente do apontador para a tabela, que é
+       o único campo do shard que os leitores leem;
+    -> Leitores (readCHT): não usam locks, nem esperam ou repetem a procura por causa de um escritor. Uma leitura percorre no máximo size posições
+       da tabela que encontrou, quaisquer que sejam as escritas concorrentes (wait-free).
+    -> Libertação da memória (reclamação por épocas): uma entrada substituída, ou uma tabela antiga, ainda pode estar a ser lida, por isso é retirada
+       com a época global atual e só é libertada quando nenhum leitor ativo tiver anunciado uma época <= essa:
+        > cada thread leitora tem um slot, numa linha de cache só sua, onde anuncia a época global ao começar uma leitura (e 0 ao terminar);
+        > quando um shard acumula retirados suficientes, o escritor avança a época global e liberta os que já nenhum leitor pode estar a ler.
+          Um leitor lento só atrasa essa libertação: nenhum escritor ou leitor espera por ele.
+    -> Até CHT_MAX_THREADS threads podem ter slot ao mesmo tempo (o slot é devolvido quando a thread termina); uma thread sem slot lê com o
+       lock do shard.
+*/
+
+#define CHT_SHARDS 64
+#define CHT_MAX_THREADS 128
+#define CHT_LOTE 64          // nº mínimo de retirados de um shard para o escritor tentar libertá-los
+
+// Cabeçalho comum da memória retirada (entradas e tabelas)
+typedef struct lixoCHT {
+    struct lixoCHT *prox;
+    uint64_t epoca;       // época global quando foi retirada
+} LixoCHT;
+
+typedef struct {
+    LixoCHT lixo;
+    uint64_t hash;
+    int value;
+    unsigned len;
+    char key[];           // bytes da chave (sem '\0')
+} EntradaCHT;
+
+typedef struct {
+    LixoCHT lixo;
+    int size;             // sempre uma potência de 2
+    EntradaCHT *slot[];   // NULL (livre), CHT_APAGADA ou uma entrada
+} TabelaCHT;
+
+static EntradaCHT marcaApagada;
+#define CHT_APAGADA (&marcaApagada)
+
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock; // campos usados só pelos escritores
+    int used, ocupadas;    // nº de chaves; posições que não estão NULL (chaves e CHT_APAGADA)
+    LixoCHT *retirados;    // memória retirada, à espera de que nenhum leitor a possa estar a ler
+    int nretirados;
+    int limite;            // nº de retirados a partir do qual o escritor tenta libertá-los
+    _Alignas(64) TabelaCHT *tbl; // tabela publicada: o único campo lido pelos leitores
+} Shard;
+
+typedef struct {
+    _Alignas(64) uint64_t epoca;   // (slot de uma thread) época anunciada, 0 se a thread não está a ler
+} SlotCHT;
+
+typedef struct {
+    SlotCHT epoca;         // época global (numa linha de cache só sua)
+    int nshards;
+    uint64_t seed;
+    Shard *shards;
+    SlotCHT *slots;        // CHT_MAX_THREADS slots, um por thread leitora
+} CHT;
+
+/* Slots das threads
+    O nº do slot de uma thread é o mesmo em todas as CHT. É reservado na primeira leitura e devolvido quando a thread termina (destrutor de uma
+pthread_key), para que threads criadas e terminadas repetidamente (p.e. no benchmark) não esgotem os slots.
+*/
+static int slotsOcupados[CHT_MAX_THREADS];
+static _Thread_local int idCHT = -1;
+static pthread_key_t chaveCHT;
+static pthread_once_t onceCHT = PTHREAD_ONCE_INIT;
+
+static void largaSlotCHT (void *p){
+    __atomic_store_n (&slotsOcupados[(intptr_t) p - 1], 0, __ATOMIC_RELEASE);
+}
+
+static void criaChaveCHT (void){
+    pthread_key_create (&chaveCHT, largaSlotCHT);
+}
+
+// Função auxiliar que devolve o nº do slot da thread (-1 se todos os slots estiverem ocupados)
+static int idLeitorCHT (void){
+    int i, z;
+    if (idCHT >= 0) return idCHT;
+    pthread_once (&onceCHT, criaChaveCHT);
+    for (i = 0; i < CHT_MAX_THREADS; i++){
+        z = 0;
+        if (__atomic_compare_exchange_n (&slotsOcupados[i], &z, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+            pthread_setspecific (chaveCHT, (void *) (intptr_t) (i + 1));
+            return (idCHT = i);
+        }
+    }
+    return -1;
+}
+
+// Funções auxiliares das tabelas e entradas dos shards
+static TabelaCHT *novaTabelaCHT (int size){
+    TabelaCHT *t = calloc (1, sizeof(TabelaCHT) + size * sizeof(EntradaCHT *));
+    t -> size = size;
+    return t;
+}
+
+static EntradaCHT *novaEntradaCHT (const char *key, unsigned len, uint64_t hv, int value){
+    EntradaCHT *e = malloc (sizeof(EntradaCHT) + len);
+    e -> hash = hv;
+    e -> len = len;
+    e -> value = value;
+    memcpy (e -> key, key, len);
+    return e;
+}
+
+// Função auxiliar (escritores) que procura a chave na tabela t e devolve a sua posição ou -1; em *livre fica a primeira posição NULL ou
+// CHT_APAGADA da sequência de procura
+static int findCHT (TabelaCHT *t, const char *key, unsigned len, uint64_t hv, int *livre){
+    int i = hv & (t -> size - 1), d;
+    EntradaCHT *e;
+    *livre = -1;
+    for (d = 0; d < t -> size; d++, i = (i + 1) & (t -> size - 1)){
+        e = t -> slot[i];
+        if (e == NULL){
+            if (*livre < 0) *livre = i;
+            return -1;
+        }
+        if (e == CHT_APAGADA){
+            if (*livre < 0) *livre = i;
+        }
+        else if (e -> hash == hv && e -> len == len && memcmp (e -> key, key, len) == 0) return i;
+    }
+    return -1;
+}
+
+// Função auxiliar que retira p (já inacessível a partir da tabela publicada) com a época global atual
+static void retireCHT (CHT *m, Shard *s, void *p){
+    LixoCHT *l = p;
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);   // a troca do apontador é visível antes de se ler a época
+    l -> epoca = __atomic_load_n (&m -> epoca.epoca, __ATOMIC_RELAXED);
+    l -> prox = s -> retirados;
+    s -> retirados = l;
+    s -> nretirados++;
+}
+
+// Função que liberta os retirados de um shard que nenhum leitor pode estar a ler (só é chamada por um escritor, com o lock do shard)
+static void reclaimCHT (CHT *m, Shard *s){
+    LixoCHT **l, *t;
+    uint64_t min, e;
+    int i;
+    // os leitores que começarem a partir daqui anunciam uma época maior do que a de todos os retirados
+    min = __atomic_add_fetch (&m -> epoca.epoca, 1, __ATOMIC_SEQ_CST);
+    for (i = 0; i < CHT_MAX_THREADS; i++){
+        e = __atomic_load_n (&m -> slots[i].epoca, __ATOMIC_SEQ_CST);
+        if (e != 0 && e < min) min = e;
+    }
+    for (l = &s -> retirados; *l != NULL; ){
+        if ((*l) -> epoca < min){
+            t = *l;
+            *l = t -> prox;
+            free (t);
+            s -> nretirados--;
+        }
+        else l = &(*l) -> prox;
+    }
+    // com um leitor lento, os retirados que sobram só voltam a ser percorridos quando duplicarem (custo O(1) amortizado por escrita)
+    s -> limite = (2 * s -> nretirados > CHT_LOTE ? 2 * s -> nretirados : CHT_LOTE);
+}
+
+// Função auxiliar que substitui a tabela do shard por uma nova, sem marcas CHT_APAGADA (com o dobro do tamanho, se a carga se dever às chaves)
+static void resizeCHT (CHT *m, Shard *s){
+    TabelaCHT *t = s -> tbl, *n;
+    EntradaCHT *e;
+    int size = t -> size, i, j;
+    if (s -> used + 1 > ALFA_MAX * size / 2) size *= 2;
+    n = novaTabelaCHT (size);
+    for (i = 0; i < t -> size; i++)
+        if ((e = t -> slot[i]) != NULL && e != CHT_APAGADA){
+            for (j = e -> hash & (size - 1); n -> slot[j] != NULL; j = (j + 1) & (size - 1));
+            n -> slot[j] = e;
+        }
+    s -> ocupadas = s -> used;
+    __atomic_store_n (&s -> tbl, n, __ATOMIC_RELEASE);
+    retireCHT (m, s, t);
+}
+
+// Função para iniciar uma tabela concorrente com nshards shards (potência de 2), cada um com tamanho inicial size
+void initCHT (CHT *m, int nshards, int size){
+    int i, cap = 1;
+    while (cap < size) cap *= 2;
+    m -> nshards = nshards;
+    m -> seed = randomSeed (m);
+    m -> epoca.epoca = 1;
+    m -> shards = aligned_alloc (64, nshards * sizeof(Shard));
+    m -> slots = aligned_alloc (64, CHT_MAX_THREADS * sizeof(SlotCHT));
+    for (i = 0; i < CHT_MAX_THREADS; i++) m -> slots[i].epoca = 0;
+    for (i = 0; i < nshards; i++){
+        pthread_mutex_init (&m -> shards[i].lock, NULL);
+        m -> shards[i].used = m -> shards[i].ocupadas = 0;
+        m -> shards[i].retirados = NULL;
+        m -> shards[i].nretirados = 0;
+        m -> shards[i].limite = CHT_LOTE;
+        m -> shards[i].tbl = novaTabelaCHT (cap);
+    }
+}
+
+// Função para libertar uma tabela concorrente (sem operações a decorrer)
+void destroyCHT (CHT *m){
+    Shard *s;
+    LixoCHT *l, *t;
+    int i, j;
+    for (i = 0; i < m -> nshards; i++){
+        s = &m -> shards[i];
+        for (j = 0; j < s -> tbl -> size; j++)
+            if (s -> tbl -> slot[j] != NULL && s -> tbl -> slot[j] != CHT_APAGADA) free (s -> tbl -> slot[j]);
+        free (s -> tbl);
+        for (l = s -> retirados; l != NULL; l = t){
+            t = l -> prox;
+            free (l);
+        }
+        pthread_mutex_destroy (&s -> lock);
+    }
+    free (m -> shards);
+    free (m -> slots);
+}
+
+static inline Shard *shardOf (CHT *m, uint64_t hv){
+    return &m -> shards[(hv >> 32) & (m -> nshards - 1)];
+}
+
+// Função para inserir (ou alterar) elementos numa tabela concorrente
+int writeCHT (CHT *m, char key[], int value){
+    unsigned len = strlen (key);
+    uint64_t hv = hash64 (key, len, m -> seed);
+    Shard *s = shardOf (m, hv);
+    EntradaCHT *e = novaEntradaCHT (key, len, hv, value), *ant;
+    int i, livre;
+    pthread_mutex_lock (&s -> lock);
+    if ((i = findCHT (s -> tbl, key, len, hv, &livre)) >= 0){
+        ant = s -> tbl -> slot[i];
+        __atomic_store_n (&s -> tbl -> slot[i], e, __ATOMIC_RELEASE);
+        retireCHT (m, s, ant);
+    }
+    else {
+        if (s -> ocupadas + 1 > ALFA_MAX * s -> tbl -> size){
+            resizeCHT (m, s);
+            findCHT (s -> tbl, key, len, hv, &livre);
+        }
+        if (s -> tbl -> slot[livre] == NULL) s -> ocupadas++;
+        __atomic_store_n (&s -> tbl -> slot[livre], e, __ATOMIC_RELEASE);
+        s -> used++;
+        i = livre;
+    }
+    if (s -> nretirados >= s -> limite) reclaimCHT (m, s);
+    pthread_mutex_unlock (&s -> lock);
+    return i;
+}
+
+// Função que elimina elementos de uma tabela concorrente
+int deleteCHT (CHT *m, char key[]){
+    unsigned len = strlen (key);
+    uint64_t hv = hash64 (key, len, m -> seed);
+    Shard *s = shardOf (m, hv);
+    EntradaCHT *ant;
+    int i, livre;
+    pthread_mutex_lock (&s -> lock);
+    if ((i = findCHT (s -> tbl, key, len, hv, &livre)) >= 0){
+        ant = s -> tbl -> slot[i];
+        __atomic_store_n (&s -> tbl -> slot[i], CHT_APAGADA, __ATOMIC_RELEASE);
+        retireCHT (m, s, ant);
+        s -> used--;
+        if (s -> nretirados >= s -> limite) reclaimCHT (m, s);
+    }
+    pthread_mutex_unlock (&s -> lock);
+    return i;
+}
+
+// Função para ler elementos de uma tabela concorrente (sem locks, exceto numa thread sem slot)
+int readCHT (CHT *m, char key[], int *value){
+    unsigned len = strlen (key);
+    uint64_t hv = hash64 (key, len, m -> seed);
+    Shard *s = shardOf (m, hv);
+    SlotCHT *l = NULL;
+    TabelaCHT *t;
+    EntradaCHT *e;
+    int id = idLeitorCHT (), i, d, r = -1;
+    if (id >= 0){
+        l = &m -> slots[id];
+        __atomic_store_n (&l -> epoca, __atomic_load_n (&m -> epoca.epoca, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);   // a época anunciada é visível antes de se ler qualquer apontador
+    }
+    else pthread_mutex_lock (&s -> lock);
+    t = __atomic_load_n (&s -> tbl, __ATOMIC_ACQUIRE);
+    for (i = hv & (t -> size - 1), d = 0; d < t -> size; d++, i = (i + 1) & (t -> size - 1)){
+        e = __atomic_load_n (&t -> slot[i], __ATOMIC_ACQUIRE);
+        if (e == NULL) break;
+        if (e != CHT_APAGADA && e -> hash == hv && e -> len == len && memcmp (e -> key, key, len) == 0){
+            *value = e -> value;
+            r = i;
+            break;
+        }
+    }
+    if (l != NULL) __atomic_store_n (&l -> epoca, 0, __ATOMIC_RELEASE);
+    else pthread_mutex_unlock (&s -> lock);
     return r;
-}
\ No newline at end of file
+}
+
+/* Benchmark da tabela concorrente
+    benchCHT executa nOps operações em cada uma de nThreads threads, sobre chaves "k0" ... "k(nChaves - 1)", com percLeituras % de leituras
+(as restantes dividem-se entre inserções e remoções) e devolve o débito total em operações por segundo.
+    benchEscalaCHT mostra esse débito para 1 .. maxThreads threads e para várias proporções de leituras / escritas.
+*/
+
+typedef struct {
+    CHT *m;
+    int nOps, percLeituras, nChaves;
+    uint64_t estado;   // gerador pseudo-aleatório (xorshift) da thread
+} ArgBench;
+
+static inline uint64_t xorshift (uint64_t *x){
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+void *workerBench (void *arg){
+    ArgBench *a = arg;
+    char key[24];
+    int i, op, v;
+    for (i = 0; i < a -> nOps; i++){
+        sprintf (key, "k%d", (int) (xorshift (&a -> estado) % a -> nChaves));
+        op = xorshift (&a -> estado) % 100;
+        if (op < a -> percLeituras) readCHT (a -> m, key, &v);
+        else if (op % 2 == 0) writeCHT (a -> m, key, i);
+        else deleteCHT (a -> m, key);
+    }
+    return NULL;
+}
+
+double benchCHT (CHT *m, int nThreads, int percLeituras, int nOps, int nChaves){
+    pthread_t *ts = malloc (nThreads * sizeof(pthread_t));
+    ArgBench *as = malloc (nThreads * sizeof(ArgBench));
+    struct timespec t0, t1;
+    int i;
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < nThreads; i++){
+        as[i] = (ArgBench) { m, nOps, percLeituras, nChaves, P0 * (i + 1) };
+        pthread_create (&ts[i], NULL, workerBench, &as[i]);
+    }
+    for (i = 0; i < nThreads; i++) pthread_join (ts[i], NULL);
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    free (ts);
+    free (as);
+    return ((double) nThreads * nOps / ((t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9));
+}
+
+void benchEscalaCHT (int maxThreads, int nOps, int nChaves){
+    int percs[] = {100, 95, 80, 50}, i, t, k;
+    char key[24];
+    CHT m;
+    for (i = 0; i < 4; i++){
+        printf ("%3d%% leituras:", percs[i]);
+        for (t = 1; t <= maxThreads; t++){
+            initCHT (&m, CHT_SHARDS, 16);
+            for (k = 0; k < nChaves; k += 2){   // metade das chaves presentes
+                sprintf (key, "k%d", k);
+                writeCHT (&m, key, k);
+            }
+            printf (" %d:%.2fM", t, benchCHT (&m, t, percs[i], nOps, nChaves) / 1e6);
+            destroyCHT (&m);
+        }
+        printf ("\n");
+    }
+}
@@ -45,6 +45,10 @@
 a árvore cumpra com os invariantes de tipo.
 */
 
+// Definições auxiliares para algoritmos de Heaps em C
+#include <stdlib.h>
+#include <string.h>
+
 // Cálculo da posição do "pai"
      #define PARENT(i) (i - 1) / 2
 
@@ -120,3 +124,511 @@ int extractMin (Heap *h, Elem *x){
     }
     else return 0;
 }
+
+/* Construção em tempo linear (Floyd)
+    Construir uma Heap com N inserções custa O(N log N). Se os elementos já estiverem num array, basta fazer o bubble-down de cada nodo
+interno, do último (PARENT(N-1)) até à raíz: quando tratamos o nodo i, as suas sub-árvores já são Heaps.
+    Quanto à Complexidade: metade dos nodos são folhas (0 níveis), um quarto desce no máximo 1 nível, um oitavo 2 níveis, ...
+         T(N) = N/4 * 1 + N/8 * 2 + N/16 * 3 + ... = Theta(N)
+*/
+
+// Função BubbleDown a partir da posição i de uma Heap com N elementos (com "buraco": o elemento é escrito uma só vez)
+void siftDown (Elem h[], int i, int N){
+    Elem x = h[i];
+    int menor;
+    while (LEFT(i) < N){
+        menor = LEFT(i);
+        if (RIGHT(i) < N && h[RIGHT(i)] < h[menor])
+            menor = RIGHT(i);
+        if (h[menor] >= x) break;
+        h[i] = h[menor];
+        i = menor;
+    }
+    h[i] = x;
+}
+
+// Função que transforma um array de N elementos numa minHeap
+void buildHeap (Elem h[], int N){
+    int i;
+    for (i = PARENT(N - 1); N > 1 && i >= 0; i--)
+        siftDown (h, i, N);
+}
+
+/* Heapsort
+    Com a Heap construída, trocamos repetidamente a raíz (o mínimo) com o último elemento da Heap e fazemos o bubble-down do novo
+elemento da raíz numa Heap com menos um elemento. Com uma minHeap, o array fica por ordem decrescente, logo, no fim invertemo-lo.
+    Não usa memória adicional e T(N) = O(N log N).
+*/
+
+// Função auxiliar que ordena uma minHeap de N elementos por ordem decrescente
+void sortHeapDesc (Elem h[], int N){
+    int n;
+    for (n = N - 1; n > 0; n--){
+        swap (h, 0, n);
+        siftDown (h, 0, n);
+    }
+}
+
+// Função que ordena um array de N elementos por ordem crescente
+void heapSort (Elem v[], int N){
+    int i;
+    buildHeap (v, N);
+    sortHeapDesc (v, N);
+    for (i = 0; i < N / 2; i++)
+        swap (v, i, N - 1 - i);
+}
+
+/* Operações compostas
+    > replaceTop: retira o mínimo e insere x, com um só bubble-down (em vez de extractMin seguido de insertHeap);
+    > pushPop: insere x e retira o mínimo. Se x não for maior do que o mínimo, a Heap nem é alterada.
+*/
+
+// Função que substitui o mínimo da Heap por x, colocando o antigo mínimo em *old (devolve 0 se a Heap estiver vazia)
+int replaceTop (Heap *h, Elem x, Elem *old){
+    if (h->used == 0) return 0;
+    *old = h->values[0];
+    h->values[0] = x;
+    siftDown (h->values, 0, h->used);
+    return 1;
+}
+
+// Função que insere x e retira o mínimo, colocando-o em *out
+void pushPop (Heap *h, Elem x, Elem *out){
+    if (h->used == 0 || x <= h->values[0])
+        *out = x;
+    else {
+        *out = h->values[0];
+        h->values[0] = x;
+        siftDown (h->values, 0, h->used);
+    }
+}
+
+/* Top-k de uma sequência
+    Para obter os k maiores elementos de uma sequência (possivelmente muito grande), mantemos uma minHeap com capacidade k:
+      > enquanto houver espaço, o elemento é inserido;
+      > depois, se o elemento for maior do que o mínimo da Heap, substitui-o (replaceTop); caso contrário é descartado em Theta(1).
+    A Heap usa um array dado pelo utilizador (não há alocações) e cada elemento é processado uma só vez: T(N) = O(N log k).
+*/
+
+// Função que inicia uma Heap de top-k sobre o array buf (com capacidade para k elementos)
+void initTopK (Heap *h, Elem buf[], int k){
+    h->values = buf;
+    h->size = k;
+    h->used = 0;
+}
+
+// Função que processa o próximo elemento da sequência
+void addTopK (Heap *h, Elem x){
+    Elem old;
+    if (h->used < h->size){
+        h->values[h->used] = x;
+        (h->used)++;
+        bubbleUp (h->values, h->used - 1);
+    }
+    else if (h->size > 0 && x > h->values[0])
+        replaceTop (h, x, &old);
+}
+
+// Função que ordena os elementos guardados por ordem decrescente (a Heap deixa de ser válida) e devolve quantos são
+int resultTopK (Heap *h){
+    sortHeapDesc (h->values, h->used);
+    return h->used;
+}
+
+/* Heaps Indexadas (filas de prioridade com decreaseKey)
+    Em algoritmos como o de Dijkstra, a orla guarda vértices {0, ..., N-1} ordenados por uma chave (W) que pode diminuir enquanto o vértice está na orla.
+    Para isso, além do array values, guardamos:
+      > chave[v] -> a prioridade do vértice v;
+      > pos[v] -> a posição de v no array values (mapa vértice -> posição).
+    Desta forma, sabemos em Theta(1) onde está um vértice e podemos fazer o bubble-up a partir dessa posição.
+    Quanto à Complexidade:
+      > insertHeapIdx, extractMinIdx e decreaseKey: O(log N);
+      > contains: Theta(1).
+*/
+
+typedef struct{
+    int size;     // nº de vértices suportados
+    int used;
+    int *values;  // vértices, organizados em minHeap pelas suas chaves
+    int *chave;   // chave[v] -> prioridade do vértice v
+    int *pos;     // pos[v] -> posição do vértice v no array values
+} HeapIdx;
+
+// Função para iniciar uma Heap indexada para os vértices {0, ..., n-1}
+void initHeapIdx (HeapIdx *h, int n){
+    h->values = malloc (n * sizeof(int));
+    h->chave = malloc (n * sizeof(int));
+    h->pos = calloc (n, sizeof(int)); // pos[v] é sempre uma posição válida, mesmo para vértices fora da heap
+    h->size = n;
+    h->used = 0;
+}
+
+// Função para libertar uma Heap indexada
+void freeHeapIdx (HeapIdx *h){
+    free (h->values);
+    free (h->chave);
+    free (h->pos);
+}
+
+// Função que testa se o vértice v está na Heap
+int contains (HeapIdx *h, int v){
+    int i = h->pos[v];
+    return (i < h->used && h->values[i] == v);
+}
+
+// Função auxiliar que troca duas posições da Heap, mantendo o mapa pos atualizado
+void swapIdx (HeapIdx *h, int a, int b){
+    int temp = h->values[a];
+    h->values[a] = h->values[b];
+    h->values[b] = temp;
+    h->pos[h->values[a]] = a;
+    h->pos[h->values[b]] = b;
+}
+
+// Função BubbleUp a partir da posição i
+void bubbleUpIdx (HeapIdx *h, int i){
+    while (i > 0 && h->chave[h->values[i]] < h->chave[h->values[PARENT(i)]])
+    {
+      swapIdx (h, i, PARENT(i));
+      i = PARENT(i);
+    }
+}
+
+// Função BubbleDown a partir da posição i
+void bubbleDownIdx (HeapIdx *h, int i){
+    int menor, flag = 1;
+    while (LEFT(i) < h->used && flag){
+        menor = LEFT(i);
+        if (RIGHT(i) < h->used && h->chave[h->values[RIGHT(i)]] < h->chave[h->values[menor]])
+            menor = RIGHT(i);
+        if (h->chave[h->values[menor]] < h->chave[h->values[i]]){
+            swapIdx (h, i, menor);
+            i = menor;
+        }
+        else
+            flag = 0;
+    }
+}
+
+// Função para inserir o vértice v com chave k (devolve 0 se v já estiver na Heap)
+int insertHeapIdx (HeapIdx *h, int v, int k){
+    if (contains (h, v)) return 0;
+    h->values[h->used] = v;
+    h->pos[v] = h->used;
+    h->chave[v] = k;
+    (h->used)++;
+    bubbleUpIdx (h, h->used - 1);
+    return 1;
+}
+
+// Função para extrair o vértice com menor chave da Heap
+int extractMinIdx (HeapIdx *h, int *v){
+    if (h->used > 0){
+        *v = h->values[0];
+        (h->used)--;
+        if (h->used > 0){
+            h->values[0] = h->values[h->used];
+            h->pos[h->values[0]] = 0;
+            bubbleDownIdx (h, 0);
+        }
+        return 1;
+    }
+    else return 0;
+}
+
+// Função que diminui a chave do vértice v para k (devolve 0 se v não estiver na Heap ou k não for menor)
+int decreaseKey (HeapIdx *h, int v, int k){
+    if (!contains (h, v) || k >= h->chave[v]) return 0;
+    h->chave[v] = k;
+    bubbleUpIdx (h, h->pos[v]);
+    return 1;
+}
+
+/* Heaps d-árias genéricas
+    A Heap acima só guarda ints, é binária e faz um swap completo em cada nível. Uma Heap d-ária generaliza-a:
+      > cada nodo tem d filhos (d = 2, 4 ou 8): o filho j de i está na posição d*i + j (j = 1..d) e o pai de i em (i - 1) / d;
+      > a altura passa a ser log_d(N), logo, o bubble-up faz menos níveis; o bubble-down faz d - 1 comparações por nível, mas os d filhos
+estão seguidos em memória, e uma Heap 4-ária costuma ser mais rápida do que a binária;
+      > os elementos são pares (chave, valor), com o tipo da chave, o do valor e a comparação fixados em tempo de compilação (definindo
+DHEAP_KEY, DHEAP_VAL e DHEAP_LESS antes de incluir este ficheiro), para que a comparação não seja uma chamada a uma função.
+    Em vez de trocar o elemento com o pai (ou filho) em cada nível, abrimos um "buraco": os elementos que estão no caminho avançam uma posição
+e o elemento é escrito uma única vez, no fim.
+    Para os d filhos de um nodo ficarem na mesma linha de cache, o array começa d - 1 posições depois de um endereço alinhado a 64 bytes:
+assim, os filhos de i (d*i + 1 .. d*i + d) ocupam as posições reais d*(i + 1) .. d*(i + 1) + d - 1.
+*/
+
+#ifndef DHEAP_KEY
+#define DHEAP_KEY int
+#endif
+
+#ifndef DHEAP_VAL
+#define DHEAP_VAL int
+#endif
+
+#ifndef DHEAP_LESS
+#define DHEAP_LESS(a, b) ((a) < (b))
+#endif
+
+typedef struct{
+    DHEAP_KEY key;
+    DHEAP_VAL val;
+} DItem;
+
+typedef struct{
+    int d;        // aridade (2, 4 ou 8)
+    int size;
+    int used;
+    DItem *values;  // values[0 .. used-1]
+    DItem *base;    // bloco alinhado (values = base + d - 1)
+} DHeap;
+
+// Função auxiliar que reserva um bloco alinhado para n elementos de uma Heap de aridade d
+DItem *allocDHeap (int d, int n){
+    size_t bytes = (n + d - 1) * sizeof(DItem);
+    return aligned_alloc (64, (bytes + 63) / 64 * 64);
+}
+
+// Função para iniciar uma Heap d-ária com capacidade inicial n (devolve 0 se d não for 2, 4 ou 8)
+int initDHeap (DHeap *h, int d, int n){
+    if (d != 2 && d != 4 && d != 8) return 0;
+    if (n < 1) n = 1;
+    h->d = d;
+    h->size = n;
+    h->used = 0;
+    h->base = allocDHeap (d, n);
+    h->values = h->base + d - 1;
+    return 1;
+}
+
+// Função para libertar uma Heap d-ária
+void freeDHeap (DHeap *h){
+    free (h->base);
+    h->base = h->values = NULL;
+    h->size = h->used = 0;
+}
+
+// Função BubbleUp a partir da posição i (com buraco): coloca x na posição i ou num dos seus antecessores
+void siftUpD (DHeap *h, int i, DItem x){
+    int p;
+    while (i > 0 && DHEAP_LESS(x.key, h->values[p = (i - 1) / h->d].key)){
+        h->values[i] = h->values[p];
+        i = p;
+    }
+    h->values[i] = x;
+}
+
+// Função BubbleDown a partir da posição i (com buraco): coloca x na posição i ou num dos seus descendentes
+void siftDownD (DHeap *h, int i, DItem x){
+    int c, j, fim, menor, d = h->d, n = h->used;
+    DItem *v = h->values;
+    while ((c = d * i + 1) < n){
+        fim = (c + d < n) ? c + d : n;
+        menor = c;
+        for (j = c + 1; j < fim; j++)
+            if (DHEAP_LESS(v[j].key, v[menor].key)) menor = j;
+        if (!DHEAP_LESS(v[menor].key, x.key)) break;
+        v[i] = v[menor];
+        i = menor;
+    }
+    v[i] = x;
+}
+
+// Função para inserir o par (k, x) na Heap d-ária
+int insertDHeap (DHeap *h, DHEAP_KEY k, DHEAP_VAL x){
+    DItem *novo;
+    if (h->used == h->size){
+        novo = allocDHeap (h->d, 2 * h->size);
+        memcpy (novo + h->d - 1, h->values, h->used * sizeof(DItem));
+        free (h->base);
+        h->base = novo;
+        h->values = novo + h->d - 1;
+        h->size *= 2;
+    }
+    (h->used)++;
+    siftUpD (h, h->used - 1, (DItem) {k, x});
+    return 1;
+}
+
+// Função que consulta o par com menor chave sem o retirar
+int topDHeap (DHeap *h, DHEAP_KEY *k, DHEAP_VAL *x){
+    if (h->used == 0) return 0;
+    *k = h->values[0].key;
+    *x = h->values[0].val;
+    return 1;
+}
+
+// Função para extrair o par com menor chave da Heap d-ária
+int extractMinDHeap (DHeap *h, DHEAP_KEY *k, DHEAP_VAL *x){
+    if (h->used == 0) return 0;
+    *k = h->values[0].key;
+    *x = h->values[0].val;
+    (h->used)--;
+    if (h->used > 0) siftDownD (h, 0, h->values[h->used]);
+    return 1;
+}
+
+/* Filas de prioridade monótonas (chaves inteiras)
+    No algoritmo de Dijkstra com pesos inteiros não negativos, as chaves extraídas nunca diminuem: nenhuma chave inserida é menor do que
+a última extraída. Nesse caso, podemos usar estruturas sem comparações entre elementos, organizadas em baldes:
+      > Radix Heap: o balde de uma chave k é dado pelo bit mais significativo em que k difere da última chave extraída (last):
+            balde(k) = 0 se k == last, 32 - clz(k ^ last) caso contrário
+        Quando o balde 0 está vazio, procuramos o primeiro balde não vazio, o seu mínimo passa a ser last, e os seus elementos são redistribuídos
+        por baldes de índice menor. Cada elemento só desce de balde, no máximo 32 vezes, logo:
+            T_Adicionar = O(1), T_Selecionar = O(log C) amortizado (C a maior chave)
+      > Dial (bucket queue): se os pesos forem no máximo C, as chaves na fila estão sempre em [cur, cur + C], e basta um array circular de C + 1
+        baldes, em que o balde k % (C + 1) guarda os elementos com chave k. Extrair é avançar cur até um balde não vazio:
+            T_Adicionar = O(1), T_Selecionar = O(1) amortizado (O(C) no total por cada valor de cur)
+    Nenhuma das duas tem decreaseKey: o elemento é inserido outra vez com a nova chave e cabe a quem extrai ignorar as cópias antigas.
+*/
+
+typedef struct{
+    int k, v;     // chave, elemento
+} ParKV;
+
+typedef struct{
+    int n, cap;
+    ParKV *e;
+} Balde;
+
+// Função auxiliar que acrescenta o par (k, v) a um balde
+void pushBalde (Balde *b, int k, int v){
+    if (b->n == b->cap){
+        b->cap = b->cap ? 2 * b->cap : 16;
+        b->e = realloc (b->e, b->cap * sizeof(ParKV));
+    }
+    b->e[b->n].k = k;
+    b->e[b->n].v = v;
+    (b->n)++;
+}
+
+#define RADIX_BALDES 33
+
+typedef struct{
+    unsigned last;  // última chave extraída
+    int used;
+    Balde b[RADIX_BALDES];
+} RadixHeap;
+
+// Função para iniciar uma Radix Heap (para a esvaziar, mantendo a memória dos baldes, usa-se clearRadix)
+void initRadix (RadixHeap *h){
+    memset (h, 0, sizeof(RadixHeap));
+}
+
+void clearRadix (RadixHeap *h){
+    int i;
+    for (i = 0; i < RADIX_BALDES; i++) h->b[i].n = 0;
+    h->last = 0;
+    h->used = 0;
+}
+
+void freeRadix (RadixHeap *h){
+    int i;
+    for (i = 0; i < RADIX_BALDES; i++) free (h->b[i].e);
+    initRadix (h);
+}
+
+// Função auxiliar que calcula o balde da chave k
+static inline int baldeRadix (RadixHeap *h, unsigned k){
+    return (k == h->last) ? 0 : 32 - __builtin_clz (k ^ h->last);
+}
+
+// Função para inserir o elemento v com chave k (requires k >= última chave extraída)
+void insertRadix (RadixHeap *h, int v, int k){
+    pushBalde (&h->b[baldeRadix (h, k)], k, v);
+    (h->used)++;
+}
+
+// Função para extrair o elemento com menor chave
+int extractMinRadix (RadixHeap *h, int *v, int *k){
+    Balde *b;
+    ParKV x;
+    int i, j;
+    unsigned m;
+    if (h->used == 0) return 0;
+    if (h->b[0].n == 0){
+        for (i = 1; h->b[i].n == 0; i++);
+        b = &h->b[i];
+        m = b->e[0].k;
+        for (j = 1; j < b->n; j++)
+            if ((unsigned) b->e[j].k < m) m = b->e[j].k;
+        h->last = m;
+        for (j = 0; j < b->n; j++){  // todos vão para baldes < i
+            x = b->e[j];
+            pushBalde (&h->b[baldeRadix (h, x.k)], x.k, x.v);
+        }
+        b->n = 0;
+    }
+    b = &h->b[0];
+    (b->n)--;
+    *v = b->e[b->n].v;
+    *k = b->e[b->n].k;
+    (h->used)--;
+    return 1;
+}
+
+typedef struct{
+    int nb;       // nº de baldes (maior peso + 1)
+    int cur;      // chave do balde atual (todas as chaves na fila estão em [cur, cur + nb - 1])
+    int used;
+    Balde *b;
+} Dial;
+
+// Função para iniciar uma Dial para pesos em [0, maxPeso] (se aparecer um peso maior, os baldes são aumentados, ver insertDial)
+void initDial (Dial *h, int maxPeso){
+    h->nb = maxPeso + 1;
+    h->cur = 0;
+    h->used = 0;
+    h->b = calloc (h->nb, sizeof(Balde));
+}
+
+void clearDial (Dial *h){
+    int i;
+    for (i = 0; i < h->nb; i++) h->b[i].n = 0;
+    h->cur = 0;
+    h->used = 0;
+}
+
+void freeDial (Dial *h){
+    int i;
+    for (i = 0; i < h->nb; i++) free (h->b[i].e);
+    free (h->b);
+    h->b = NULL;
+    h->nb = 0;
+}
+
+// Função auxiliar que passa a Dial a ter nb baldes, redistribuindo os elementos (a chave k passa para o balde k % nb)
+void growDial (Dial *h, int nb){
+    Balde *ant = h->b;
+    int i, j, n = h->nb;
+    h->b = calloc (nb, sizeof(Balde));
+    h->nb = nb;
+    for (i = 0; i < n; i++){
+        for (j = 0; j < ant[i].n; j++)
+            pushBalde (&h->b[ant[i].e[j].k % nb], ant[i].e[j].k, ant[i].e[j].v);
+        free (ant[i].e);
+    }
+    free (ant);
+}
+
+// Função para inserir o elemento v com chave k (devolve -1, sem inserir, se k < cur)
+// Se k > cur + nb - 1 (peso maior do que o maxPeso indicado), o balde de k coincidiria com o de uma chave menor: os baldes são aumentados antes
+int insertDial (Dial *h, int v, int k){
+    if (k < h->cur) return -1;
+    if (k - h->cur >= h->nb) growDial (h, (k - h->cur + 1 > 2 * h->nb) ? k - h->cur + 1 : 2 * h->nb);
+    pushBalde (&h->b[k % h->nb], k, v);
+    (h->used)++;
+    return 0;
+}
+
+// Função para extrair o elemento com menor chave
+int extractMinDial (Dial *h, int *v, int *k){
+    Balde *b;
+    if (h->used == 0) return 0;
+    while (h->b[h->cur % h->nb].n == 0) (h->cur)++;
+    b = &h->b[h->cur % h->nb];
+    (b->n)--;
+    *v = b->e[b->n].v;
+    *k = b->e[b->n].k;
+    (h->used)--;
+    return 1;
+}
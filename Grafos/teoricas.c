@@ -1,5 +1,15 @@
+#define _POSIX_C_SOURCE 200112L // pthread_barrier_t e clock_gettime também com -std=c11
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "../Estruturas de Dados/heaps.c" // HeapIdx, usada como orla no algoritmo de Dijkstra
 // Aulas Teóricas de Grafos
 
 /* Aplicações de Grafos:
@@ -8,7 +18,7 @@
    > Arestas são ruas a ligar os cruzamentos.
 */
 
-/* Vértices são representados por {0,1,...,N-1}
+/* Vértices são representados por {0,1,...,V-1}
    e estão relacionados por arestas, p.e. x está relacionado com y == existe um aresta x ---> y
 */
 
@@ -19,20 +29,27 @@
 
 // Representação de grafos:
 
-#define V 100 // V é o número de vértices
+/* O número de vértices (V) não é fixo: cada grafo é reservado na heap com o seu tamanho e guarda o seu nº de vértices (nv) e de arestas (na).
+*/
+
 #define NE 0 // aresta nula
 
 // 1. Grafo em forma de matrizes de adjacência:
 
-typedef int GrafoM[V][V]; /* note-se que esta representação é demasiado pesada, pois, tipicamente, o número de arestas é muito inferior a (V^2), 
+typedef struct grafoM {
+    int nv, na;  // nº de vértices e nº de arestas
+    int *m;      // matriz nv x nv guardada por linhas
+} *GrafoM; /* note-se que esta representação é demasiado pesada, pois, tipicamente, o número de arestas é muito inferior a (V^2), 
                            logo, estamos a desperdiçar recursos. 
     Seja GrafoM g, em que:
-      1. g[2][3] = 3
-         > Concluímos que existe um aresta com Origem 2, Destino 5 e Peso 3
-      2. g[3][6] = 0
+      1. PESO(g, 2, 3) = 3
+         > Concluímos que existe um aresta com Origem 2, Destino 3 e Peso 3
+      2. PESO(g, 3, 6) = 0
          > Concluímos que não existe nenhuma aresta de 3 para 6
     */
 
+#define PESO(g, o, d) ((g)->m[(size_t) (o) * (g)->nv + (d)]) // posição (o, d) da matriz
+
 // 2. Grafo em forma de lista de adjacência:
 
 typedef struct aresta
@@ -41,24 +58,343 @@ typedef struct aresta
     struct aresta *prox; 
 } *ListaAdj;
 
-typedef ListaAdj GrafoL[V]; /* geralmente, vamos utilizar esta representação, pois no caso médio, apresenta melhor complexidade que os grafos representados em
+typedef struct grafoL {
+    int nv, na;      // nº de vértices e nº de arestas
+    ListaAdj *adj;   // adj[o] é a lista de adjacência do vértice o
+    struct indiceArestas *idx;   // índice de arestas (opcional, ver indexaL), ou NULL
+} *GrafoL; /* geralmente, vamos utilizar esta representação, pois no caso médio, apresenta melhor complexidade que os grafos representados em
                               matrizes de adjacência
                            */
 
+// 3. Grafo em forma de CSR (Compressed Sparse Row):
+
+typedef struct {
+    int nv, na;     // nº de vértices e nº de arestas
+    int *offsets;   // as arestas com origem o ocupam as posições [offsets[o], offsets[o + 1]) dos arrays seguintes (offsets tem nv + 1 posições)
+    int *destino;   // destino de cada aresta (na posições)
+    int *peso;      // peso de cada aresta (na posições)
+} GrafoCSR; /* guarda as mesmas arestas que a lista de adjacência, mas em arrays contíguos, logo, percorrer os adjacentes de um vértice é uma leitura
+               sequencial da memória (em vez de um acesso a uma posição arbitrária da memória por cada aresta).
+               É uma representação estática: deve ser construída (ver csrFromL, csrFromM, csrFromArestas) depois de o grafo estar completo.
+            */
+
+// 4. Grafo em forma de matriz de bits:
+
+typedef struct {
+    int nv, na;      // nº de vértices e nº de arestas
+    int palavras;    // nº de palavras de 64 bits de cada linha (múltiplo de 4, para as linhas ficarem alinhadas a 32 bytes)
+    uint64_t *m;     // matriz nv x (64 * palavras) de bits, guardada por linhas: o bit d da linha o está a 1 sse existe a aresta o -> d
+} GrafoBits; /* é uma matriz de adjacência sem pesos (só diz se a aresta existe), mas com um bit por par de vértices em vez de um int,
+                logo, ocupa 32 vezes menos memória que um GrafoM. Contar arestas passa a ser contar bits a 1 (popcount) de 64 em 64 pares,
+                e os vizinhos comuns de dois vértices são o AND das suas linhas.
+             */
+
 
 /* Para o cálculo da complexidade das diversas funções de grafos que iremos reproduzir, devemos considerar o tamanho do input (V,E) em que V representa o número
 de vértices do grafo e E o número de arestas.
 */
 
+/* Índice de arestas (opcional) de um GrafoL
+   Saber se existe a aresta o -> d numa lista de adjacência obriga a percorrer a lista de o (O(grau de o)), o que é demasiado lento para vértices
+com grau muito grande (hubs). Um grafo pode ter um índice (criado com indexaL), que é mantido por addArestaL e usado por haArestaL:
+   -> enquanto o grau de o é menor que INDICE_HUB, os destinos de o são guardados num array ordenado (sem repetidos), onde se procura d com
+      pesquisa galopante (posições 1, 2, 4, 8, ... até passar d, seguida de pesquisa binária nesse intervalo);
+   -> quando o grau de o chega a INDICE_HUB, os seus destinos passam para uma tabela de hash (partilhada pelos hubs todos) de pares (o, destino),
+      com linear probing, onde uma procura custa, em média, Theta(1).
+   Assim, os vértices com poucos adjacentes (a maioria) gastam só um int por aresta, e os hubs não pagam o custo de inserir em arrays ordenados
+enormes.
+*/
+
+#define INDICE_HUB 512          // grau a partir do qual os destinos de um vértice passam para a tabela de hash
+#define INDICE_VAZIO UINT64_MAX // posição livre da tabela de hash
+
+typedef struct {
+    int n, cap;   // nº de destinos e capacidade do array
+    int *d;       // destinos, por ordem crescente (NULL se o vértice é um hub)
+    int hub;      // 1 se os destinos estão na tabela de hash
+} DestinosIdx;
+
+struct indiceArestas {
+    DestinosIdx *v;    // v[o] para cada vértice o
+    uint64_t *tab;     // pares ((uint64_t) o << 32 | destino) dos hubs
+    size_t size, used; // tamanho da tabela (potência de 2) e nº de posições ocupadas
+};
+
+// Função auxiliar que devolve a posição de (o, d) na tabela (ou a posição livre onde deve ser inserido)
+static size_t posIndice (struct indiceArestas *ix, uint64_t chave)
+{
+    size_t i = (chave * 0x9e3779b97f4a7c15ULL) >> 32 & (ix->size - 1);   // hashing de Fibonacci
+    while (ix->tab[i] != INDICE_VAZIO && ix->tab[i] != chave) i = (i + 1) & (ix->size - 1);
+    return i;
+}
+
+// Função auxiliar que insere (o, d) na tabela de hash (duplicando o tamanho quando o fator de carga passa 0.75)
+static void insereTabIndice (struct indiceArestas *ix, int o, int d)
+{
+    uint64_t chave = (uint64_t) o << 32 | (uint32_t) d, *velha = ix->tab;
+    size_t i, n = ix->size;
+    if (4 * (ix->used + 1) > 3 * ix->size){
+        ix->size = (ix->size == 0) ? 1024 : 2 * ix->size;
+        ix->tab = malloc (ix->size * sizeof(uint64_t));
+        memset (ix->tab, 0xff, ix->size * sizeof(uint64_t));   // todas a INDICE_VAZIO
+        for (i = 0; i < n; i++)
+            if (velha[i] != INDICE_VAZIO) ix->tab[posIndice (ix, velha[i])] = velha[i];
+        free (velha);
+    }
+    i = posIndice (ix, chave);
+    if (ix->tab[i] == INDICE_VAZIO){
+        ix->tab[i] = chave;
+        ix->used++;
+    }
+}
+
+// Função auxiliar (pesquisa galopante) que devolve a 1ª posição i >= ini de a[0..n-1] (ordenado) com a[i] >= d
+static int galopa (int a[], int ini, int n, int d)
+{
+    int passo = 1, lo = ini, hi = ini, m;
+    while (hi < n && a[hi] < d){   // a[lo..hi-1] < d
+        lo = hi + 1;
+        hi += passo;
+        passo *= 2;
+    }
+    if (hi > n) hi = n;
+    while (lo < hi){   // pesquisa binária em [lo, hi]
+        m = lo + (hi - lo) / 2;
+        if (a[m] < d) lo = m + 1;
+        else hi = m;
+    }
+    return lo;
+}
+
+// Função auxiliar que acrescenta o -> d ao índice (se ainda não estiver lá)
+static void insereIndice (struct indiceArestas *ix, int o, int d)
+{
+    DestinosIdx *v = &ix->v[o];
+    int i;
+    if (v->hub){
+        insereTabIndice (ix, o, d);
+        return;
+    }
+    i = galopa (v->d, 0, v->n, d);
+    if (i < v->n && v->d[i] == d) return;
+    if (v->n + 1 >= INDICE_HUB){   // o passa a ser um hub
+        for (i = 0; i < v->n; i++) insereTabIndice (ix, o, v->d[i]);
+        insereTabIndice (ix, o, d);
+        free (v->d);
+        v->d = NULL;
+        v->n = v->cap = 0;
+        v->hub = 1;
+        return;
+    }
+    if (v->n == v->cap){
+        v->cap = (v->cap == 0) ? 4 : 2 * v->cap;
+        v->d = realloc (v->d, v->cap * sizeof(int));
+    }
+    memmove (v->d + i + 1, v->d + i, (v->n - i) * sizeof(int));
+    v->d[i] = d;
+    v->n++;
+}
+
+// Função auxiliar que testa se o -> d está no índice
+static int temIndice (struct indiceArestas *ix, int o, int d)
+{
+    DestinosIdx *v = &ix->v[o];
+    int i;
+    if (v->hub) return (ix->tab[posIndice (ix, (uint64_t) o << 32 | (uint32_t) d)] != INDICE_VAZIO);
+    i = galopa (v->d, 0, v->n, d);
+    return (i < v->n && v->d[i] == d);
+}
+
+// Funções para criar, libertar e acrescentar arestas aos grafos
+
+GrafoM novoGrafoM (int nv)
+{
+    GrafoM g = malloc (sizeof (struct grafoM));
+    g->nv = nv;
+    g->na = 0;
+    g->m = calloc ((size_t) nv * nv, sizeof(int));
+    return g;
+}
+
+GrafoL novoGrafoL (int nv)
+{
+    GrafoL g = malloc (sizeof (struct grafoL));
+    g->nv = nv;
+    g->na = 0;
+    g->adj = calloc (nv, sizeof(ListaAdj));
+    g->idx = NULL;
+    return g;
+}
+
+void freeGrafoM (GrafoM g)
+{
+    free (g->m);
+    free (g);
+}
+
+// Função que liberta o índice de arestas de g (se existir); g continua válido, mas sem índice
+void freeIndiceL (GrafoL g)
+{
+    int o;
+    if (g->idx == NULL) return;
+    for (o = 0; o < g->nv; o++) free (g->idx->v[o].d);
+    free (g->idx->v);
+    free (g->idx->tab);
+    free (g->idx);
+    g->idx = NULL;
+}
+
+void freeGrafoL (GrafoL g)
+{
+    int o;
+    ListaAdj x, t;
+    freeIndiceL (g);
+    for (o = 0; o < g->nv; o++)
+        for (x = g->adj[o]; x != NULL; x = t){
+            t = x->prox;
+            free (x);
+        }
+    free (g->adj);
+    free (g);
+}
+
+// requires (p != NE)
+void addArestaM (GrafoM g, int o, int d, int p)
+{
+    if (PESO(g, o, d) == NE) g->na++;
+    PESO(g, o, d) = p;
+}
+
+// Acrescenta a aresta o -> d no início da lista de o (não verifica se a aresta já existe)
+void addArestaL (GrafoL g, int o, int d, int p)
+{
+    ListaAdj x = malloc (sizeof (struct aresta));
+    x->destino = d;
+    x->peso = p;
+    x->prox = g->adj[o];
+    g->adj[o] = x;
+    g->na++;
+    if (g->idx != NULL) insereIndice (g->idx, o, d);
+}
+
+// Função que cria o índice de arestas de g (com as arestas que g já tem); a partir daqui, addArestaL mantém-no atualizado
+void indexaL (GrafoL g)
+{
+    ListaAdj x;
+    int o;
+    if (g->idx != NULL) return;
+    g->idx = malloc (sizeof (struct indiceArestas));
+    g->idx->v = calloc (g->nv, sizeof(DestinosIdx));
+    g->idx->tab = NULL;
+    g->idx->size = g->idx->used = 0;
+    for (o = 0; o < g->nv; o++)
+        for (x = g->adj[o]; x != NULL; x = x->prox)
+            insereIndice (g->idx, o, x->destino);
+}
+// A Complexidade desta função é dada por: T(V,E) = O(V + E * INDICE_HUB) no pior caso (inserções a meio dos arrays ordenados)
+
+// Função que devolve o grafo transposto de g (com as arestas invertidas)
+GrafoL transpostaL (GrafoL g)
+{
+    GrafoL t = novoGrafoL (g->nv);
+    ListaAdj x;
+    int o;
+    for (o = 0; o < g->nv; o++)
+        for (x = g->adj[o]; x != NULL; x = x->prox)
+            addArestaL (t, x->destino, o, x->peso);
+    return t;
+}
+
+/* Buffers de trabalho
+   Os algoritmos abaixo precisam de estado com uma posição por vértice (cor, orla, ...). Em vez de o reservarem (e inicializarem) em cada chamada,
+recebem um Buffers, reservado uma vez pelo chamador e reutilizado em todas as consultas sobre grafos com até n vértices.
+   Para não ser preciso voltar a pôr todos os vértices a Branco no início de cada consulta, a cor de v é guardada relativamente a uma época:
+        marca[v] <= epoca                    -> v é Branco
+        marca[v] == epoca + c (c = 1 ou 2)    -> v tem a cor c (Cinzento ou Preto)
+   Assim, novaConsulta só tem de avançar a época (custo Theta(1), exceto quando o contador dá a volta, caso raro em que se limpa o array).
+*/
+
+typedef struct {
+    int n;            // nº de vértices suportados
+    unsigned epoca;
+    unsigned *marca;  // cor de cada vértice na consulta atual (relativa a epoca)
+    int *orla;        // queue / stack de vértices
+    int *orla2;       // segunda queue (procura bidirecional)
+    ListaAdj *iterL;  // iterL[v] -> próxima aresta de v a examinar (travessia em profundidade iterativa)
+    int *iterCSR;     // o mesmo, para GrafoCSR
+    int tipoOrla;     // estrutura usada como orla no Dijkstra (ORLA_HEAP, ORLA_RADIX ou ORLA_DIAL)
+    HeapIdx heap;     // orla ordenada por W (Dijkstra)
+    RadixHeap radix;
+    Dial dial;
+} Buffers;
+
+#define ORLA_HEAP 0
+#define ORLA_RADIX 1
+#define ORLA_DIAL 2
+
+void initBuffers (Buffers *b, int n)
+{
+    b->n = n;
+    b->epoca = 0;
+    b->marca = calloc (n, sizeof(unsigned));
+    b->orla = malloc (n * sizeof(int));
+    b->orla2 = malloc (n * sizeof(int));
+    b->iterL = malloc (n * sizeof(ListaAdj));
+    b->iterCSR = malloc (n * sizeof(int));
+    b->tipoOrla = ORLA_HEAP;
+    initHeapIdx (&b->heap, n);
+    initRadix (&b->radix);
+    b->dial.nb = 0;
+    b->dial.b = NULL;
+}
+
+void freeBuffers (Buffers *b)
+{
+    free (b->marca);
+    free (b->orla);
+    free (b->orla2);
+    free (b->iterL);
+    free (b->iterCSR);
+    freeHeapIdx (&b->heap);
+    freeRadix (&b->radix);
+    freeDial (&b->dial);
+}
+
+// Função que põe todos os vértices a Branco e esvazia a orla
+void novaConsulta (Buffers *b)
+{
+    if (b->epoca > (unsigned) -1 - 4){
+        memset (b->marca, 0, b->n * sizeof(unsigned));
+        b->epoca = 0;
+    }
+    else b->epoca += 2;
+    b->heap.used = 0;
+    if (b->tipoOrla == ORLA_RADIX) clearRadix (&b->radix);
+    if (b->tipoOrla == ORLA_DIAL) clearDial (&b->dial);
+}
+
+#define COR(b, v) ((b)->marca[v] > (b)->epoca ? (int) ((b)->marca[v] - (b)->epoca) : 0)
+#define PINTA(b, v, c) ((b)->marca[v] = (b)->epoca + (c))
+
+// Função que escolhe a orla usada pelo Dijkstra (maxPeso, o maior peso de uma aresta, só é usado pela ORLA_DIAL para o nº inicial de baldes)
+void escolheOrla (Buffers *b, int tipo, int maxPeso)
+{
+    b->tipoOrla = tipo;
+    if (tipo == ORLA_DIAL){
+        freeDial (&b->dial);
+        initDial (&b->dial, maxPeso);
+    }
+}
+
 
 // Função que conta quantas Arestas tem um grafo orientado
 
 int contaArestasM (GrafoM g)
 {
     int o, d, r = 0;
-    for (o = 0; o < V; o++)
-      for (d = 0; d < V; d++)
-        if (g[o][d] != 0) r++;
+    for (o = 0; o < g->nv; o++)
+      for (d = 0; d < g->nv; d++)
+        if (PESO(g, o, d) != 0) r++;
     return r;
 }
 // A Complexidade desta função é dada por: T(V,E) = Theta(V^2)
@@ -67,9 +403,9 @@ int contaArestasL (GrafoL g)
 {
     int o, r = 0;
     ListaAdj x;
-    for (o = 0; o < V; o++)
-       for (x = g[o]; x != NULL; x = x->prox) r++;
-    return r;
+    for (o = 0; o < g->nv; o++)
+       for (x = g->adj[o]; x != NULL; x = x->prox) r++;
+    return r;   // igual a g->na
 }
 // A Complexidade desta função é dada por: T(V,E) = Theta(V + E)
 
@@ -84,9 +420,9 @@ int outDegreeL (GrafoL g)
 {
     int o, r = 0, t;
     ListaAdj x;
-    for (o = 0; o < V; o++){
+    for (o = 0; o < g->nv; o++){
         t = 0;
-        for (x = g[o]; x != NULL; x = x->prox) t++;
+        for (x = g->adj[o]; x != NULL; x = x->prox) t++;
         if (t > r) r = t;
     }
     return r;
@@ -96,10 +432,10 @@ int outDegreeL (GrafoL g)
 int outDegreeM (GrafoM g)
 {
     int o, d, r = 0, t;
-    for (o = 0; o < V; o++){
+    for (o = 0; o < g->nv; o++){
         t = 0;
-        for (d = 0; d < V; d++)
-          if (g[o][d] != 0) t++;
+        for (d = 0; d < g->nv; d++)
+          if (PESO(g, o, d) != 0) t++;
         if (t > r) r = t;
     }
     return r;
@@ -111,32 +447,113 @@ int outDegreeM (GrafoM g)
 
 int haArestaM (GrafoM g, int o, int d)
 {
-    return (g[o][d] != 0);
+    return (PESO(g, o, d) != 0);
 }
 // A Complexidade desta função é dada por: T(V,E) = Theta(1)
 
 int haArestaL (GrafoL g, int o, int d)
 {
     ListaAdj x;
-    for (x = g[o]; x != NULL && x->destino != d; x = x->prox);
+    if (g->idx != NULL) return temIndice (g->idx, o, d);
+    for (x = g->adj[o]; x != NULL && x->destino != d; x = x->prox);
     return (x != NULL);
 }
 /* A Complexidade desta função é dada por: 
   > No melhor caso (quando o 1º elemento avaliado é o vértice destino procurado) = Omega(1)
   > No pior caso (tem de percorrer toda a lista, ou seja, o vértice destino procurado é o último elemento) = O(V)
+   Se g tiver índice (indexaL), passa a O(log(grau de o)) para os vértices com grau < INDICE_HUB e a Theta(1) (em média) para os hubs.
+*/
+
+// Acrescenta a aresta o -> d só se ainda não existir (devolve 1 se a acrescentou); com índice, custa O(log(grau de o)) em vez de O(grau de o)
+int addArestaUnicaL (GrafoL g, int o, int d, int p)
+{
+    if (haArestaL (g, o, d)) return 0;
+    addArestaL (g, o, d, p);
+    return 1;
+}
+
+/* Função que testa várias arestas com a mesma origem: r[i] = haArestaL (g, o, ds[i]), para 0 <= i < n.
+   Com índice e ds por ordem crescente, cada pesquisa galopante começa onde acabou a anterior, logo, o custo total no array de o é
+O(n * log(grau de o / n)) em vez de O(n * log(grau de o)).
+*/
+void haArestasL (GrafoL g, int o, int ds[], int n, int r[])
+{
+    DestinosIdx *v;
+    int i, j = 0;
+    if (g->idx == NULL || g->idx->v[o].hub){
+        for (i = 0; i < n; i++) r[i] = haArestaL (g, o, ds[i]);
+        return;
+    }
+    v = &g->idx->v[o];
+    for (i = 0; i < n; i++){
+        if (i > 0 && ds[i] < ds[i - 1]) j = 0;   // fora de ordem: recomeçar do início
+        j = galopa (v->d, j, v->n, ds[i]);
+        r[i] = (j < v->n && v->d[j] == ds[i]);
+    }
+}
+
+
+/* Travessia em profundidade iterativa
+   As versões recursivas abaixo (procuraAux, travessiaDepthFirstAux) fazem uma chamada por vértice do caminho atual: num grafo em cadeia
+com milhões de vértices, a stack da thread esgota-se. A alternativa é guardar explicitamente a stack de vértices (em b->orla) e, para cada
+vértice na stack, a próxima aresta a examinar (b->iterL[v]), que é o estado que a recursão guardava em cada chamada:
+   -> topo da stack com arestas por examinar: avança o seu iterador e, se o destino for Branco, empilha-o (pré-ordem);
+   -> topo da stack sem arestas: desempilha-o (pós-ordem).
+   As funções pre e post (que podem ser NULL) são chamadas em pré-ordem e em pós-ordem com o vértice, o seu pai na árvore da travessia (-1 para
+a raíz) e ctx; se devolverem um valor diferente de 0, a travessia termina.
+   Cores: Branco (0) por visitar, Cinzento (1) na stack, Preto (2) terminado. dfsL não chama novaConsulta, logo, pode ser chamada para
+várias raízes seguidas (por exemplo, para visitar o grafo todo).
+   Devolve o nº de vértices visitados. Complexidade: T(V,E) = O(V + E), com memória adicional Theta(V) fora da stack.
 */
 
+typedef int (*VisitaDFS) (int v, int pai, void *ctx);
+
+int dfsL (GrafoL g, int o, Buffers *b, VisitaDFS pre, VisitaDFS post, void *ctx)
+{
+    int *pilha = b->orla, sp = 0, r = 1, v, d;
+    ListaAdj x;
+    PINTA(b, o, 1);
+    if (pre != NULL && pre (o, -1, ctx)) return r;
+    pilha[sp++] = o;
+    b->iterL[o] = g->adj[o];
+    while (sp > 0){
+        v = pilha[sp - 1];
+        for (x = b->iterL[v]; x != NULL && COR(b, x->destino) != 0; x = x->prox);
+        if (x != NULL){
+            b->iterL[v] = x->prox;
+            d = x->destino;
+            PINTA(b, d, 1);
+            r++;
+            if (pre != NULL && pre (d, v, ctx)) return r;
+            b->iterL[d] = g->adj[d];
+            pilha[sp++] = d;
+        }
+        else {
+            sp--;
+            PINTA(b, v, 2);
+            if (post != NULL && post (v, sp > 0 ? pilha[sp - 1] : -1, ctx)) return r;
+        }
+    }
+    return r;
+}
+
+// Função auxiliar (pré-ordem) que termina a travessia quando chega ao vértice *ctx
+int chegouA (int v, int pai, void *ctx)
+{
+    (void) pai;
+    return (v == *(int *) ctx);
+}
 
 // Função que procura um caminho (se d é alcançável a partir de o)
 
-int procuraAux (GrafoL g, int o, int d, int vis[])
+int procuraAux (GrafoL g, int o, int d, Buffers *vis)
 {
     ListaAdj x;
-    vis[o] = 1; // não iniciamos mais procuras a partir da origem
+    PINTA(vis, o, 1); // não iniciamos mais procuras a partir da origem
     if (o == d) return 1;
-    for (x = g[o]; x != NULL; x = x->prox){
+    for (x = g->adj[o]; x != NULL; x = x->prox){
         // Existe uma aresta desde o até x->destino com peso x->peso
-        if (vis[x->destino] == 0 // ainda não procuramos a partir deste ponto
+        if (COR(vis, x->destino) == 0 // ainda não procuramos a partir deste ponto
             && 
             procuraAux(g, x->destino, d, vis)) return 1;
     }
@@ -144,14 +561,14 @@ int procuraAux (GrafoL g, int o, int d, int vis[])
 }
 // A Complexidade desta função é dada por T(V,E) = O(V + E)
 
-int procura (GrafoL g, int o, int d)
+int procura (GrafoL g, int o, int d, Buffers *vis)
 {
-    int vis[V]; // a dimensão do array vis é o número de vértices, pois, é utilizado para testar por quais vértices já passamos
-    int i;
-    for (i = 0; i < V; i++) vis[i] = 0;
-    return (procuraAux(g,o,d,vis));
+    // vis tem uma posição por vértice, pois, é utilizado para testar por quais vértices já passamos
+    novaConsulta (vis);
+    dfsL (g, o, vis, chegouA, NULL, &d);   // o mesmo que procuraAux(g,o,d,vis), sem recursão
+    return (COR(vis, d) != 0);
 }
-/* A Complexidade desta função é dada por T(V,E) = V + T_procuraAux(V,E) = V + V + E = O(V + E)
+/* A Complexidade desta função é dada por T(V,E) = T_novaConsulta + T_procuraAux(V,E) = 1 + V + E = O(V + E)
    Podemos considerar esta função linear, pois percorremos toda a estrutura apenas uma vez.
 */
 
@@ -159,24 +576,63 @@ int procura (GrafoL g, int o, int d)
 
 // Função que analisa a travessia em profundidade e a sua função auxiliar
 
-int travessiaDepthFirstAux (GrafoL g, int o, int vis[])
+int travessiaDepthFirstAux (GrafoL g, int o, Buffers *vis)
 {
     int r;
     ListaAdj x;
-    vis[o] = 1;
+    PINTA(vis, o, 1);
     r = 1;
-    for (x = g[o]; x != NULL; x = x->prox)
-       if (vis[x->destino] == 0)
+    for (x = g->adj[o]; x != NULL; x = x->prox)
+       if (COR(vis, x->destino) == 0)
           r += travessiaDepthFirstAux (g, x->destino, vis);
     return r;
 }
 
-int travessiaDepthFirst (GrafoL g, int o)
+int travessiaDepthFirst (GrafoL g, int o, Buffers *vis)
 {
-    int v[V];
-    int i;
-    for (i = 0; i < V; i++) v[i] = 0;
-    return (travessiaDepthFirstAux(g, o, v));   // retorna o número de vértices alcançáveis a partir de o
+    novaConsulta (vis);
+    return (dfsL(g, o, vis, NULL, NULL, NULL));   // retorna o número de vértices alcançáveis a partir de o (como travessiaDepthFirstAux)
+}
+
+/* Procura bidirecional
+   Para saber se d é alcançável a partir de o, expandimos em largura, ao mesmo tempo, os vértices alcançáveis a partir de o (no grafo g, a
+Cinzento) e os vértices a partir dos quais d é alcançável (no transposto gt, a Preto). Em cada passo expande-se um nível completo da orla
+mais pequena; a procura termina assim que uma das expansões encontra um vértice da outra cor.
+   Se cada vértice tiver k sucessores e o caminho tiver comprimento l, uma procura só a partir de o examina cerca de k^l vértices, enquanto a
+bidirecional examina cerca de 2 * k^(l/2). No pior caso (d não alcançável) continua a ser O(V + E).
+*/
+
+int procuraBiL (GrafoL g, GrafoL gt, int o, int d, Buffers *b)
+{
+    int *fa = b->orla, *fb = b->orla2, ia = 0, na = 0, ib = 0, nb = 0, fim;
+    ListaAdj x;
+    novaConsulta (b);
+    if (o == d) return 1;
+    PINTA(b, o, 1);
+    fa[na++] = o;
+    PINTA(b, d, 2);
+    fb[nb++] = d;
+    while (ia < na && ib < nb){
+        if (na - ia <= nb - ib)
+            for (fim = na; ia < fim; ia++)
+                for (x = g->adj[fa[ia]]; x != NULL; x = x->prox){
+                    if (COR(b, x->destino) == 2) return 1;
+                    if (COR(b, x->destino) == 0){
+                        PINTA(b, x->destino, 1);
+                        fa[na++] = x->destino;
+                    }
+                }
+        else
+            for (fim = nb; ib < fim; ib++)
+                for (x = gt->adj[fb[ib]]; x != NULL; x = x->prox){
+                    if (COR(b, x->destino) == 1) return 1;
+                    if (COR(b, x->destino) == 0){
+                        PINTA(b, x->destino, 2);
+                        fb[nb++] = x->destino;
+                    }
+                }
+    }
+    return 0;
 }
 
 /* Outro modo de travessia de um grafo é a travessia em largura.
@@ -207,41 +663,40 @@ Para estes algoritmos devemos:
 #define Cinzento 1
 #define Preto 2
 
-int travessiaBreadthFirst (GrafoL g, int o, int alc[], int pais[])
+int travessiaBreadthFirst (GrafoL g, int o, int alc[], int pais[], Buffers *b)
 {
     // retorna o nº de vértices alcançáveis a partir de o
     // preenche o array alc com 1 se o vértice for alcançável de o
     // preenche o array pais com a árvore produzida
 
-    int cor[V];
-    int orla[V];
+    int *orla = b->orla;
     int tamOrla, r, v;
     int inicio0, fim0;                // estas duas variáveis com o array orla são suficientes para definir uma Queue Orla
     ListaAdj x;
     r = 0;
-    for (int i = 0; i < V; i++){
+    for (int i = 0; i < g->nv; i++){
         alc[i] = 0;
         pais[i] = -2;
     }
-    for (int i = 0; i < V; i++) cor[i] = Branco;
+    novaConsulta (b);                 // todos os vértices a Branco
     tamOrla = 0;
     inicio0 = fim0 = 0;            // queue vazia
-    cor[o] = Cinzento;
+    PINTA(b, o, Cinzento);
     orla[fim0++] = o;            // enqueue (orla, o)
     tamOrla = 1;
     pais[o] = -1;
     while (fim0 != inicio0){   // tamanho da orla > 0
      // escolha do vértice v da orla (cinzento)
         v = orla[inicio0++];  // dequeue (orla)
-        cor[v] = Preto;
+        PINTA(b, v, Preto);
         tamOrla--;
         r++;
         alc[v] = 1;
-        for (x = g[v]; x != NULL; x = x->prox){
+        for (x = g->adj[v]; x != NULL; x = x->prox){
             // existe uma aresta de v e destino x->destino
-            if (cor[x->destino] == Branco){
+            if (COR(b, x->destino) == Branco){
                 orla[fim0++] = x->destino;   // enqueue (orla, x->destino)
-                cor[x->destino] = Cinzento;
+                PINTA(b, x->destino, Cinzento);
                 tamOrla++;
                 pais[x -> destino] = v;
             }
@@ -266,47 +721,77 @@ definidos anteriormente.
         -> Podemos adaptar o algoritmo "travessiaBreadthFirst" para o obter (a grande diferença é que a orla deixa de ser uma queue)
 */
 
+/* Orlas alternativas
+   Com pesos inteiros não negativos, as chaves extraídas da orla nunca diminuem e podemos usar uma Radix Heap ou uma Dial (ver heaps.c) em vez da
+min-heap. Como estas não têm decreaseKey, atualizar W[d] insere d outra vez e, ao extrair, as cópias de vértices já Pretos são ignoradas.
+   A orla é escolhida em tempo de execução com escolheOrla; estas funções escondem a diferença do DijkstraSP.
+*/
+
+void orlaInsere (Buffers *b, int v, int k)
+{
+    switch (b->tipoOrla){
+        case ORLA_HEAP: insertHeapIdx (&b->heap, v, k); break;
+        case ORLA_RADIX: insertRadix (&b->radix, v, k); break;
+        case ORLA_DIAL: insertDial (&b->dial, v, k); break;
+    }
+}
+
+void orlaAtualiza (Buffers *b, int v, int k)
+{
+    if (b->tipoOrla == ORLA_HEAP) decreaseKey (&b->heap, v, k);
+    else orlaInsere (b, v, k);
+}
+
+// Função que extrai da orla o vértice (Cinzento) com menor W (devolve 0 se a orla estiver vazia)
+int orlaExtrai (Buffers *b, int *v)
+{
+    int k, r;
+    do {
+        switch (b->tipoOrla){
+            case ORLA_RADIX: r = extractMinRadix (&b->radix, v, &k); break;
+            case ORLA_DIAL: r = extractMinDial (&b->dial, v, &k); break;
+            default: return extractMinIdx (&b->heap, v);
+        }
+    } while (r && COR(b, *v) == Preto);   // cópia antiga de um vértice já tratado
+    return r;
+}
+
 // Função que calcula o caminho mais curto com base no algoritmo de Dijkstra
 
-int DijkstraSP (GrafoL g, int o, int alc[], int pais[], int W[]){
-    int cor[V];
-    // podemos definir a orla de diversas maneiras
-    int tamOrla, r, v;
+int DijkstraSP (GrafoL g, int o, int alc[], int pais[], int W[], Buffers *b){
+    // a orla é, por omissão, uma min-heap indexada ordenada por W (opção 3. abaixo)
+    int r, v;
     ListaAdj x;
 
     r = 0;
-    for (int i = 0; i < V; i++){
+    for (int i = 0; i < g->nv; i++){
         alc[i] = 0;
         pais[i] = -2;
-        cor[i] = Branco;
     }
-    for (int i = 0; i < V; i++) cor[i] = Branco;
-    tamOrla = 0;
-    cor[o] = Cinzento;
+    novaConsulta (b);
+    PINTA(b, o, Cinzento);
     W[o] = 0;
-    // adicionar o à orla
-    tamOrla = 1;
+    orlaInsere (b, o, W[o]);    // adicionar o à orla
     pais[o] = -1;
-    while (tamOrla > 0){   // tamanho da orla > 0
-     // escolha do vértice v da orla (cinzento)
-     // depende da definição da orla
-        cor[v] = Preto;
-        tamOrla--;
+    while (orlaExtrai (b, &v)){   // tamanho da orla > 0
+     // escolha do vértice v da orla (cinzento) com menor W
+        PINTA(b, v, Preto);
         r++;
         alc[v] = 1;
-        for (x = g[v]; x != NULL; x = x->prox){
+        for (x = g->adj[v]; x != NULL; x = x->prox){
             // existe uma aresta de v e destino x -> destino ccom peso x -> peso
-            if (cor[x->destino] == Branco){
+            if (COR(b, x->destino) == Branco){
                 // x -> destino é não visitado
                 // adicionar x -> destino à orla
-                cor[x->destino] = Cinzento;
-                tamOrla++;
+                PINTA(b, x->destino, Cinzento);
                 pais[x -> destino] = v;
                 W[x -> destino] = W[v] + x -> peso;
+                orlaInsere (b, x -> destino, W[x -> destino]);
             }
-            else if (cor [x -> destino] == Cinzento && W[v] + x -> peso < W[x -> destino]){
+            else if (COR(b, x -> destino) == Cinzento && W[v] + x -> peso < W[x -> destino]){
                 W[x -> destino] = W[v] + x -> peso;
                 pais [x -> destino] = v;
+                orlaAtualiza (b, x -> destino, W[x -> destino]);
             }
         }
     
@@ -348,6 +833,7 @@ de funcionar com arestas de peso negativo.
 */
 
 // Definiremos a ideia base de implementação deste algoritmo:
+#if 0 // pseudocódigo (não compila)
  
      g+ = g; // Para ser possível cumprir o invariante de ciclo não podemos ter vértices intermédios inicialmente, para isso, inicializamos g+ como g
     for (i = 0; i < V; i++)
@@ -365,27 +851,1468 @@ de funcionar com arestas de peso negativo.
         for (a in antecessores(i))
             for (b in sucessores(i))
                 acrescentar info da aresta (a,b);
-    
+#endif
+
 // Uma opção de definir o algoritmo será:
 void floydWarshall (GrafoL g, GrafoM gp){
     ListaAdj it;
     int cost, u, v, x;
 
-    // inicializar gp
-    for (u = 0; u < V; u++){
-        for (v = 0; v < V; v++)
-            gp[u][v] = NE;
-        for (it = g[u]; it != NULL; it = it -> prox)
-            gp[v][it -> destino] = it -> peso;
+    // inicializar gp (reservado pelo chamador com g->nv vértices)
+    for (u = 0; u < g->nv; u++){
+        for (v = 0; v < g->nv; v++)
+            PESO(gp, u, v) = NE;
+        for (it = g->adj[u]; it != NULL; it = it -> prox)
+            PESO(gp, u, it -> destino) = it -> peso;
     }
     // adição de arestas
-    for (x = 0; x < V; x++)
-        for (u = 0; u < V; u++)
-            for (v = 0; v < V; v++)
-                if(gp[u][x] != NE && gp[x][v] != NE){
-                    cost = gp[u][x] + gp[x][v];
-                    if(gp[u][v] == NE || gp[u][v] > cost)
-                        gp[u][v] = cost;
+    for (x = 0; x < g->nv; x++)
+        for (u = 0; u < g->nv; u++)
+            for (v = 0; v < g->nv; v++)
+                if(PESO(gp, u, x) != NE && PESO(gp, x, v) != NE){
+                    cost = PESO(gp, u, x) + PESO(gp, x, v);
+                    if(PESO(gp, u, v) == NE || PESO(gp, u, v) > cost)
+                        PESO(gp, u, v) = cost;
                 }
 }
 // A complexidade deste Algoritmo é dado por  T_warshall (V, E) = (V^2) + V * (V * V) = (V^2) + (V^3) = Theta (V^3)
+
+/* Floyd-Warshall por blocos
+   A versão acima percorre a matriz inteira V vezes, com um teste (NE) no ciclo interior, o que impede o compilador de a vetorizar. Melhorias:
+   -> Sentinela: "não há caminho" é INF = INT_MAX / 2 (e d[u][u] = 0), logo, INF + INF não dá overflow e o ciclo interior fica só
+        nd = d[i][k] + d[k][j];  d[i][j] = nd < d[i][j] ? nd : d[i][j];
+      sem saltos condicionais, que o compilador transforma em instruções vetoriais (min / blend) com -O3 -mavx2.
+   -> Blocos: a matriz é dividida em blocos de FW_BLOCO x FW_BLOCO (as linhas são alargadas até um múltiplo de FW_BLOCO). Na ronda K (vértices
+intermédios do bloco K):
+        1. o bloco diagonal (K, K) é atualizado com ele próprio;
+        2. os blocos da linha K e da coluna K só dependem de si próprios e do bloco (K, K);
+        3. cada um dos restantes blocos (I, J) só depende de (I, K) e (K, J), que já estão finais nesta ronda.
+      Os blocos de cada fase são independentes e são repartidos pelas threads (com uma barreira entre fases). Cada bloco cabe na cache, e é
+reutilizado FW_BLOCO vezes antes de sair.
+   -> Predecessores: p[i][j] é o vértice anterior a j no caminho mais curto de i para j (-1 se não existir). Fazer p[i][j] = p[k][j] quando k
+melhora o caminho de i para j não serve com blocos: p[k][j] pode ainda não ser final nessa ronda e, com ciclos de peso 0 (ou gerados por arestas
+negativas), p chega a ter ciclos. Por isso o kernel só calcula distâncias e, no fim, cada linha i de p é reconstruída com uma travessia em largura
+a partir de i pelas arestas "justas" (d[i][u] + peso(u, v) == d[i][v]): cada vértice recebe como predecessor o primeiro vértice que o alcança,
+logo, p[i] é uma árvore. Custa Theta(V * (V + E)) e as linhas são repartidas pelas threads.
+   -> Com pesos negativos (sem ciclos negativos), INF + (peso negativo) pode ficar ligeiramente abaixo de INF; no fim, todas as distâncias
+>= INF / 2 voltam a ser INF.
+   A complexidade continua a ser Theta(V^3), mas com V^3 / FW_BLOCO acessos a memória fora da cache em vez de V^3.
+*/
+
+#define INF (INT_MAX / 2)
+#define FW_BLOCO 64
+
+typedef struct {
+    int nv;
+    int ld;      // nº de colunas de cada linha (nv arredondado a um múltiplo de FW_BLOCO)
+    int *d;      // d[i * ld + j] -> distância de i a j
+    int *p;      // p[i * ld + j] -> predecessor de j no caminho de i para j
+} Distancias;
+
+void freeDistancias (Distancias *r)
+{
+    free (r->d);
+    free (r->p);
+}
+
+// Função auxiliar que atualiza o bloco (bi, bj) usando como intermédios os vértices do bloco bk
+static void blocoFW (Distancias *r, int bi, int bj, int bk)
+{
+    int ld = r->ld, i, j, k, dik, nd;
+    int *dij;
+    const int *dkj;
+    for (k = bk * FW_BLOCO; k < (bk + 1) * FW_BLOCO; k++)
+        for (i = bi * FW_BLOCO; i < (bi + 1) * FW_BLOCO; i++){
+            dik = r->d[(size_t) i * ld + k];
+            dij = r->d + (size_t) i * ld + bj * FW_BLOCO;
+            dkj = r->d + (size_t) k * ld + bj * FW_BLOCO;
+            for (j = 0; j < FW_BLOCO; j++){
+                nd = dik + dkj[j];
+                dij[j] = nd < dij[j] ? nd : dij[j];
+            }
+        }
+}
+
+// Função auxiliar que reconstrói a linha o de p a partir das distâncias finais (fila tem espaço para nv vértices)
+static void predecessoresFW (GrafoL g, Distancias *r, int o, int fila[])
+{
+    const int *d = r->d + (size_t) o * r->ld;
+    int *p = r->p + (size_t) o * r->ld;
+    int ini = 0, fim = 0, u;
+    ListaAdj it;
+    for (u = 0; u < g->nv; u++) p[u] = -1;
+    fila[fim++] = o;
+    while (ini < fim){
+        u = fila[ini++];
+        for (it = g->adj[u]; it != NULL; it = it -> prox)
+            if (it->destino != o && p[it->destino] == -1 && d[it->destino] != INF && d[u] + it->peso == d[it->destino]){
+                p[it->destino] = u;
+                fila[fim++] = it->destino;
+            }
+    }
+}
+
+typedef struct {
+    GrafoL g;
+    Distancias *r;
+    int id, nThreads;
+    pthread_barrier_t *barreira;
+} ArgFW;
+
+void *workerFW (void *arg)
+{
+    ArgFW *a = arg;
+    int nb = a->r->ld / FW_BLOCO, k, i, j, t;
+    for (k = 0; k < nb; k++){
+        if (a->id == 0) blocoFW (a->r, k, k, k);                  // 1. bloco diagonal
+        pthread_barrier_wait (a->barreira);
+        for (t = a->id; t < 2 * nb; t += a->nThreads){             // 2. linha e coluna K
+            i = t % nb;
+            if (i == k) continue;
+            if (t < nb) blocoFW (a->r, k, i, k);
+            else blocoFW (a->r, i, k, k);
+        }
+        pthread_barrier_wait (a->barreira);
+        for (t = a->id; t < nb * nb; t += a->nThreads){            // 3. restantes blocos
+            i = t / nb;
+            j = t % nb;
+            if (i != k && j != k) blocoFW (a->r, i, j, k);
+        }
+        pthread_barrier_wait (a->barreira);
+    }
+    return NULL;
+}
+
+void *workerPredFW (void *arg)
+{
+    ArgFW *a = arg;
+    int *fila = malloc (a->g->nv * sizeof(int)), o;
+    for (o = a->id; o < a->g->nv; o += a->nThreads)
+        predecessoresFW (a->g, a->r, o, fila);
+    free (fila);
+    return NULL;
+}
+
+// Função que calcula as distâncias (e predecessores) entre todos os pares de vértices de g, usando nThreads threads
+void floydWarshallBlocos (GrafoL g, Distancias *r, int nThreads)
+{
+    ListaAdj it;
+    ArgFW *as;
+    pthread_t *ts;
+    pthread_barrier_t barreira;
+    size_t tam;
+    int u, v, ld;
+
+    r->nv = g->nv;
+    r->ld = ld = (g->nv + FW_BLOCO - 1) / FW_BLOCO * FW_BLOCO;
+    tam = (size_t) ld * ld * sizeof(int);
+    r->d = aligned_alloc (64, tam);
+    r->p = aligned_alloc (64, tam);
+    for (u = 0; u < ld; u++)
+        for (v = 0; v < ld; v++)
+            r->d[(size_t) u * ld + v] = (u == v && u < g->nv) ? 0 : INF;
+    for (u = 0; u < g->nv; u++)
+        for (it = g->adj[u]; it != NULL; it = it -> prox)
+            if (it->destino != u && it->peso < r->d[(size_t) u * ld + it->destino])
+                r->d[(size_t) u * ld + it->destino] = it->peso;
+    if (nThreads < 1) nThreads = 1;
+    ts = malloc (nThreads * sizeof(pthread_t));
+    as = malloc (nThreads * sizeof(ArgFW));
+    pthread_barrier_init (&barreira, NULL, nThreads);
+    for (u = 0; u < nThreads; u++){
+        as[u] = (ArgFW) { g, r, u, nThreads, &barreira };
+        if (u > 0) pthread_create (&ts[u], NULL, workerFW, &as[u]);
+    }
+    workerFW (&as[0]);
+    for (u = 1; u < nThreads; u++) pthread_join (ts[u], NULL);
+    pthread_barrier_destroy (&barreira);
+    for (u = 0; u < g->nv; u++)
+        for (v = 0; v < g->nv; v++)
+            if (r->d[(size_t) u * ld + v] >= INF / 2) r->d[(size_t) u * ld + v] = INF;
+    for (u = 1; u < nThreads; u++) pthread_create (&ts[u], NULL, workerPredFW, &as[u]);
+    workerPredFW (&as[0]);
+    for (u = 1; u < nThreads; u++) pthread_join (ts[u], NULL);
+    free (ts);
+    free (as);
+}
+
+// Função que coloca em cam (com espaço para nv vértices) o caminho mais curto de o para d (o, ..., d) e devolve o seu nº de vértices
+// (0 se não existir caminho, -1 se os predecessores não levarem a o em nv passos)
+int caminhoFW (Distancias *r, int o, int d, int cam[])
+{
+    int n = 0, v, t;
+    if (r->d[(size_t) o * r->ld + d] == INF) return 0;
+    for (v = d; v != o; v = r->p[(size_t) o * r->ld + v]){
+        if (v < 0 || n == r->nv - 1) return -1;
+        cam[n++] = v;
+    }
+    cam[n++] = o;
+    for (v = 0; v < n / 2; v++){
+        t = cam[v];
+        cam[v] = cam[n - 1 - v];
+        cam[n - 1 - v] = t;
+    }
+    return n;
+}
+
+/* Algoritmo de Bellman-Ford (variante SPFA)
+   Ao contrário do Dijkstra, funciona com arestas de peso negativo. A versão clássica relaxa todas as arestas V - 1 vezes: Theta(V * E).
+   Na variante SPFA, só voltamos a relaxar as arestas de um vértice cujo W diminuiu: esses vértices ficam numa queue (circular, sem repetições),
+e o algoritmo termina assim que a queue fica vazia, o que na prática acontece muito antes das V - 1 rondas.
+   Ciclos negativos: o caminho de o até v (seguindo pais) tem no máximo V - 1 arestas. Se, ao diminuir W[v], esse caminho passar a ter V arestas,
+então repete um vértice, ou seja, existe um ciclo de peso negativo alcançável a partir de o. Recuando V vezes pelos pais a partir de v,
+chegamos a um vértice do ciclo.
+   Com o = -1, todos os vértices são origens com W = 0 (equivale a uma origem virtual com arestas de peso 0 para todos), que é o que o
+algoritmo de Johnson precisa.
+   A complexidade desta função é dada por: T(V, E) = O(V * E) no pior caso.
+*/
+
+// Função que calcula o caminho mais curto de o para todos os vértices (W = INF se não alcançável); devolve -1 se não existir um ciclo negativo
+// alcançável, ou um vértice desse ciclo (seguindo pais a partir dele, percorre-se o ciclo)
+int bellmanFord (GrafoL g, int o, int W[], int pais[])
+{
+    int *queue = malloc (g->nv * sizeof(int)), *arestas = calloc (g->nv, sizeof(int));
+    char *naQueue = calloc (g->nv, 1);
+    int ini = 0, tam = 0, v, d, i, r = -1;
+    ListaAdj x;
+    for (v = 0; v < g->nv; v++){
+        W[v] = (o < 0) ? 0 : INF;
+        pais[v] = (o < 0) ? -1 : -2;
+        if (o < 0){
+            queue[tam++] = v;
+            naQueue[v] = 1;
+        }
+    }
+    if (o >= 0){
+        W[o] = 0;
+        pais[o] = -1;
+        queue[tam++] = o;
+        naQueue[o] = 1;
+    }
+    while (tam > 0 && r < 0){
+        v = queue[ini];
+        ini = (ini + 1) % g->nv;
+        tam--;
+        naQueue[v] = 0;
+        for (x = g->adj[v]; x != NULL && r < 0; x = x->prox){
+            d = x->destino;
+            if (W[v] + x->peso < W[d]){
+                W[d] = W[v] + x->peso;
+                pais[d] = v;
+                arestas[d] = arestas[v] + 1;
+                if (arestas[d] >= g->nv){
+                    for (i = 0; i < g->nv; i++) d = pais[d];
+                    r = d;
+                }
+                else if (!naQueue[d]){
+                    queue[(ini + tam) % g->nv] = d;
+                    tam++;
+                    naQueue[d] = 1;
+                }
+            }
+        }
+    }
+    free (queue);
+    free (arestas);
+    free (naQueue);
+    return r;
+}
+
+/* Grafos em CSR
+   Todas as funções anteriores têm uma versão para GrafoCSR. A estrutura dos algoritmos é a mesma, mas a lista de adjacentes de o é percorrida com
+        for (i = g->offsets[o]; i < g->offsets[o + 1]; i++)   // existe uma aresta de o para g->destino[i] com peso g->peso[i]
+   em vez de seguir os apontadores prox.
+*/
+
+// Função que liberta um grafo em CSR
+void freeCSR (GrafoCSR *g)
+{
+    free (g->offsets);
+    free (g->destino);
+    free (g->peso);
+}
+
+// Função auxiliar que reserva um grafo em CSR com nv vértices e na arestas
+void initCSR (GrafoCSR *g, int nv, int na)
+{
+    g->nv = nv;
+    g->na = na;
+    g->offsets = calloc (nv + 1, sizeof(int));
+    g->destino = malloc (na * sizeof(int));
+    g->peso = malloc (na * sizeof(int));
+}
+
+// Função que constrói um grafo em CSR a partir de uma lista de arestas (orig[i], dest[i], peso[i]), com 0 <= i < na
+void csrFromArestas (GrafoCSR *g, int nv, int na, int orig[], int dest[], int peso[])
+{
+    int i, o, *prox;
+    initCSR (g, nv, na);
+    // contar as arestas de cada origem
+    for (i = 0; i < na; i++) g->offsets[orig[i] + 1]++;
+    // somas prefixas: offsets[o] passa a ser a posição da 1ª aresta de o
+    for (o = 0; o < nv; o++) g->offsets[o + 1] += g->offsets[o];
+    // distribuir as arestas (mantém a ordem relativa das arestas com a mesma origem)
+    prox = malloc (nv * sizeof(int));
+    for (o = 0; o < nv; o++) prox[o] = g->offsets[o];
+    for (i = 0; i < na; i++){
+        g->destino[prox[orig[i]]] = dest[i];
+        g->peso[prox[orig[i]]++] = peso[i];
+    }
+    free (prox);
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V + E)
+
+// Função que constrói um grafo em CSR a partir de uma lista de adjacência
+void csrFromL (GrafoCSR *g, GrafoL l)
+{
+    int o, i;
+    ListaAdj x;
+    initCSR (g, l->nv, l->na);
+    for (o = 0, i = 0; o < l->nv; o++){
+        g->offsets[o] = i;
+        for (x = l->adj[o]; x != NULL; x = x->prox, i++){
+            g->destino[i] = x->destino;
+            g->peso[i] = x->peso;
+        }
+    }
+    g->offsets[l->nv] = i;
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V + E)
+
+// Função que constrói um grafo em CSR a partir de uma matriz de adjacência
+void csrFromM (GrafoCSR *g, GrafoM m)
+{
+    int o, d, i;
+    initCSR (g, m->nv, m->na);
+    for (o = 0, i = 0; o < m->nv; o++){
+        g->offsets[o] = i;
+        for (d = 0; d < m->nv; d++)
+            if (PESO(m, o, d) != NE){
+                g->destino[i] = d;
+                g->peso[i++] = PESO(m, o, d);
+            }
+    }
+    g->offsets[m->nv] = i;
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V^2)
+
+// Função que constrói o grafo transposto de g (com as arestas invertidas), ou seja, as listas de antecessores
+void csrTransposta (GrafoCSR *t, GrafoCSR *g)
+{
+    int *orig = malloc (g->na * sizeof(int)), o, i;
+    for (o = 0; o < g->nv; o++)
+        for (i = g->offsets[o]; i < g->offsets[o + 1]; i++)
+            orig[i] = o;
+    csrFromArestas (t, g->nv, g->na, g->destino, orig, g->peso);
+    free (orig);
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V + E)
+
+int contaArestasCSR (GrafoCSR *g)
+{
+    return (g->offsets[g->nv]);
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(1)
+
+int outDegreeCSR (GrafoCSR *g)
+{
+    int o, r = 0, t;
+    for (o = 0; o < g->nv; o++){
+        t = g->offsets[o + 1] - g->offsets[o];
+        if (t > r) r = t;
+    }
+    return r;
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V)
+
+int haArestaCSR (GrafoCSR *g, int o, int d)
+{
+    int i;
+    for (i = g->offsets[o]; i < g->offsets[o + 1] && g->destino[i] != d; i++);
+    return (i < g->offsets[o + 1]);
+}
+// A Complexidade desta função é igual à de haArestaL: Omega(1) e O(V)
+
+int procuraCSRAux (GrafoCSR *g, int o, int d, Buffers *vis)
+{
+    int i;
+    PINTA(vis, o, 1);
+    if (o == d) return 1;
+    for (i = g->offsets[o]; i < g->offsets[o + 1]; i++)
+        if (COR(vis, g->destino[i]) == 0 && procuraCSRAux (g, g->destino[i], d, vis)) return 1;
+    return 0;
+}
+
+// Travessia em profundidade iterativa (ver dfsL)
+int dfsCSR (GrafoCSR *g, int o, Buffers *b, VisitaDFS pre, VisitaDFS post, void *ctx)
+{
+    int *pilha = b->orla, sp = 0, r = 1, v, d, i;
+    PINTA(b, o, 1);
+    if (pre != NULL && pre (o, -1, ctx)) return r;
+    pilha[sp++] = o;
+    b->iterCSR[o] = g->offsets[o];
+    while (sp > 0){
+        v = pilha[sp - 1];
+        for (i = b->iterCSR[v]; i < g->offsets[v + 1] && COR(b, g->destino[i]) != 0; i++);
+        if (i < g->offsets[v + 1]){
+            b->iterCSR[v] = i + 1;
+            d = g->destino[i];
+            PINTA(b, d, 1);
+            r++;
+            if (pre != NULL && pre (d, v, ctx)) return r;
+            b->iterCSR[d] = g->offsets[d];
+            pilha[sp++] = d;
+        }
+        else {
+            sp--;
+            PINTA(b, v, 2);
+            if (post != NULL && post (v, sp > 0 ? pilha[sp - 1] : -1, ctx)) return r;
+        }
+    }
+    return r;
+}
+
+int procuraCSR (GrafoCSR *g, int o, int d, Buffers *vis)
+{
+    novaConsulta (vis);
+    dfsCSR (g, o, vis, chegouA, NULL, &d);
+    return (COR(vis, d) != 0);
+}
+// A Complexidade desta função é dada por T(V,E) = O(V + E)
+
+int travessiaDepthFirstCSRAux (GrafoCSR *g, int o, Buffers *vis)
+{
+    int i, r = 1;
+    PINTA(vis, o, 1);
+    for (i = g->offsets[o]; i < g->offsets[o + 1]; i++)
+        if (COR(vis, g->destino[i]) == 0)
+            r += travessiaDepthFirstCSRAux (g, g->destino[i], vis);
+    return r;
+}
+
+int travessiaDepthFirstCSR (GrafoCSR *g, int o, Buffers *vis)
+{
+    novaConsulta (vis);
+    return (dfsCSR (g, o, vis, NULL, NULL, NULL));   // retorna o número de vértices alcançáveis a partir de o
+}
+
+// Procura bidirecional (ver procuraBiL), com gt o transposto de g (ver csrTransposta)
+int procuraBiCSR (GrafoCSR *g, GrafoCSR *gt, int o, int d, Buffers *b)
+{
+    int *fa = b->orla, *fb = b->orla2, ia = 0, na = 0, ib = 0, nb = 0, fim, i;
+    novaConsulta (b);
+    if (o == d) return 1;
+    PINTA(b, o, 1);
+    fa[na++] = o;
+    PINTA(b, d, 2);
+    fb[nb++] = d;
+    while (ia < na && ib < nb){
+        if (na - ia <= nb - ib)
+            for (fim = na; ia < fim; ia++)
+                for (i = g->offsets[fa[ia]]; i < g->offsets[fa[ia] + 1]; i++){
+                    if (COR(b, g->destino[i]) == 2) return 1;
+                    if (COR(b, g->destino[i]) == 0){
+                        PINTA(b, g->destino[i], 1);
+                        fa[na++] = g->destino[i];
+                    }
+                }
+        else
+            for (fim = nb; ib < fim; ib++)
+                for (i = gt->offsets[fb[ib]]; i < gt->offsets[fb[ib] + 1]; i++){
+                    if (COR(b, gt->destino[i]) == 1) return 1;
+                    if (COR(b, gt->destino[i]) == 0){
+                        PINTA(b, gt->destino[i], 2);
+                        fb[nb++] = gt->destino[i];
+                    }
+                }
+    }
+    return 0;
+}
+
+int travessiaBreadthFirstCSR (GrafoCSR *g, int o, int alc[], int pais[], Buffers *b)
+{
+    int *orla = b->orla;
+    int r = 0, v, i, inicio0, fim0;
+    for (i = 0; i < g->nv; i++){
+        alc[i] = 0;
+        pais[i] = -2;
+    }
+    novaConsulta (b);
+    inicio0 = fim0 = 0;
+    PINTA(b, o, Cinzento);
+    orla[fim0++] = o;
+    pais[o] = -1;
+    while (fim0 != inicio0){
+        v = orla[inicio0++];
+        PINTA(b, v, Preto);
+        r++;
+        alc[v] = 1;
+        for (i = g->offsets[v]; i < g->offsets[v + 1]; i++)
+            if (COR(b, g->destino[i]) == Branco){
+                orla[fim0++] = g->destino[i];
+                PINTA(b, g->destino[i], Cinzento);
+                pais[g->destino[i]] = v;
+            }
+    }
+    return r;
+}
+
+int DijkstraSPCSR (GrafoCSR *g, int o, int alc[], int pais[], int W[], Buffers *b)
+{
+    int r = 0, v, d, i;
+    for (i = 0; i < g->nv; i++){
+        alc[i] = 0;
+        pais[i] = -2;
+    }
+    novaConsulta (b);
+    PINTA(b, o, Cinzento);
+    W[o] = 0;
+    orlaInsere (b, o, W[o]);
+    pais[o] = -1;
+    while (orlaExtrai (b, &v)){
+        PINTA(b, v, Preto);
+        r++;
+        alc[v] = 1;
+        for (i = g->offsets[v]; i < g->offsets[v + 1]; i++){
+            d = g->destino[i];
+            if (COR(b, d) == Branco){
+                PINTA(b, d, Cinzento);
+                pais[d] = v;
+                W[d] = W[v] + g->peso[i];
+                orlaInsere (b, d, W[d]);
+            }
+            else if (COR(b, d) == Cinzento && W[v] + g->peso[i] < W[d]){
+                W[d] = W[v] + g->peso[i];
+                pais[d] = v;
+                orlaAtualiza (b, d, W[d]);
+            }
+        }
+    }
+    return r;
+}
+
+/* Comparação das orlas
+   Os grafos de estradas são quase planares, com grau médio baixo e pesos inteiros pequenos. Para os imitar usamos uma grelha lado x lado
+(arestas nos dois sentidos entre vizinhos) com pesos aleatórios em [1, maxPeso] e algumas "autoestradas" entre vértices aleatórios.
+*/
+
+// Função que cria uma grelha lado x lado com pesos em [1, maxPeso]
+GrafoCSR grelhaCSR (int lado, int maxPeso)
+{
+    int n = lado * lado, m = 4 * n + n / 100, na = 0, v, i;
+    int *orig = malloc (m * sizeof(int)), *dest = malloc (m * sizeof(int)), *peso = malloc (m * sizeof(int));
+    GrafoCSR g;
+    for (v = 0; v < n; v++){
+        if (v % lado + 1 < lado){
+            orig[na] = v; dest[na] = v + 1; peso[na++] = 1 + rand () % maxPeso;
+            orig[na] = v + 1; dest[na] = v; peso[na++] = 1 + rand () % maxPeso;
+        }
+        if (v + lado < n){
+            orig[na] = v; dest[na] = v + lado; peso[na++] = 1 + rand () % maxPeso;
+            orig[na] = v + lado; dest[na] = v; peso[na++] = 1 + rand () % maxPeso;
+        }
+    }
+    for (i = 0; i < n / 100; i++){
+        orig[na] = rand () % n; dest[na] = rand () % n; peso[na++] = maxPeso;
+    }
+    csrFromArestas (&g, n, na, orig, dest, peso);
+    free (orig);
+    free (dest);
+    free (peso);
+    return g;
+}
+
+// Função que devolve o nº de consultas (DijkstraSPCSR a partir de origens aleatórias) por segundo com a orla tipo
+double benchDijkstra (GrafoCSR *g, int tipo, int maxPeso, int nConsultas)
+{
+    Buffers b;
+    struct timespec t0, t1;
+    int *alc = malloc (g->nv * sizeof(int)), *pais = malloc (g->nv * sizeof(int)), *W = malloc (g->nv * sizeof(int)), i;
+    initBuffers (&b, g->nv);
+    escolheOrla (&b, tipo, maxPeso);
+    srand (1);  // as mesmas origens para todas as orlas
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < nConsultas; i++)
+        DijkstraSPCSR (g, rand () % g->nv, alc, pais, W, &b);
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    freeBuffers (&b);
+    free (alc);
+    free (pais);
+    free (W);
+    return nConsultas / ((t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+}
+
+void benchOrlas (int lado, int maxPeso, int nConsultas)
+{
+    GrafoCSR g = grelhaCSR (lado, maxPeso);
+    printf ("grelha %dx%d, pesos em [1, %d]:", lado, lado, maxPeso);
+    printf (" heap %.2f/s", benchDijkstra (&g, ORLA_HEAP, maxPeso, nConsultas));
+    printf (" radix %.2f/s", benchDijkstra (&g, ORLA_RADIX, maxPeso, nConsultas));
+    printf (" dial %.2f/s\n", benchDijkstra (&g, ORLA_DIAL, maxPeso, nConsultas));
+    freeCSR (&g);
+}
+
+/* Algoritmo de Johnson
+   Para calcular os caminhos mais curtos entre todos os pares num grafo esparso com pesos negativos (mas sem ciclos negativos):
+        1. calculamos h = bellmanFord com origem virtual (h[v] <= 0 é o peso do caminho mais curto que termina em v);
+        2. repesamos cada aresta (u, v) com p'(u, v) = p(u, v) + h[u] - h[v], que é >= 0 (pela desigualdade triangular h[v] <= h[u] + p(u, v));
+           num caminho de o para d, os termos h intermédios anulam-se, logo, p'(caminho) = p(caminho) + h[o] - h[d] e os caminhos mais curtos
+           mantêm-se;
+        3. fazemos um Dijkstra (DijkstraSPCSR, sobre a versão CSR do grafo repesado) a partir de cada vértice e corrigimos d(o, v) = W'[v] - h[o] + h[v].
+   As V execuções do Dijkstra são independentes: um conjunto de nThreads threads vai buscando a próxima origem a um contador partilhado
+(cada thread com os seus Buffers e arrays auxiliares).
+   O resultado usa a mesma estrutura (Distancias, com ld = nv) que floydWarshallBlocos, logo, caminhoFW também serve para reconstruir os caminhos.
+   A complexidade é dada por: T(V, E) = O(V * E) (Bellman-Ford) + V * O(E * log V) (Dijkstra), em vez de Theta(V^3).
+*/
+
+typedef struct {
+    GrafoCSR *g;
+    Distancias *r;
+    int *h;
+    int *proxima;   // próxima origem a tratar (partilhada)
+} ArgJohnson;
+
+void *workerJohnson (void *arg)
+{
+    ArgJohnson *a = arg;
+    int n = a->g->nv, o, v, *alc = malloc (n * sizeof(int)), *pais = malloc (n * sizeof(int)), *W = malloc (n * sizeof(int));
+    int *d, *p;
+    Buffers b;
+    initBuffers (&b, n);
+    while ((o = __atomic_fetch_add (a->proxima, 1, __ATOMIC_RELAXED)) < n){
+        DijkstraSPCSR (a->g, o, alc, pais, W, &b);
+        d = a->r->d + (size_t) o * n;
+        p = a->r->p + (size_t) o * n;
+        for (v = 0; v < n; v++){
+            d[v] = alc[v] ? W[v] - a->h[o] + a->h[v] : INF;
+            p[v] = alc[v] ? pais[v] : -1;
+        }
+    }
+    freeBuffers (&b);
+    free (alc);
+    free (pais);
+    free (W);
+    return NULL;
+}
+
+// Função que calcula as distâncias (e predecessores) entre todos os pares de vértices de g; devolve 0 (e não preenche r) se g tiver um ciclo negativo
+int johnson (GrafoL g, Distancias *r, int nThreads)
+{
+    int *h = malloc (g->nv * sizeof(int)), *pais = malloc (g->nv * sizeof(int)), proxima = 0, i, j;
+    GrafoCSR gr;
+    ArgJohnson a;
+    pthread_t *ts;
+    if (bellmanFord (g, -1, h, pais) >= 0){
+        free (h);
+        free (pais);
+        return 0;
+    }
+    csrFromL (&gr, g);
+    for (i = 0; i < gr.nv; i++)
+        for (j = gr.offsets[i]; j < gr.offsets[i + 1]; j++)
+            gr.peso[j] += h[i] - h[gr.destino[j]];
+    r->nv = r->ld = g->nv;
+    r->d = malloc ((size_t) g->nv * g->nv * sizeof(int));
+    r->p = malloc ((size_t) g->nv * g->nv * sizeof(int));
+    a = (ArgJohnson) { &gr, r, h, &proxima };
+    if (nThreads < 1) nThreads = 1;
+    ts = malloc (nThreads * sizeof(pthread_t));
+    for (i = 1; i < nThreads; i++) pthread_create (&ts[i], NULL, workerJohnson, &a);
+    workerJohnson (&a);
+    for (i = 1; i < nThreads; i++) pthread_join (ts[i], NULL);
+    free (ts);
+    freeCSR (&gr);
+    free (h);
+    free (pais);
+    return 1;
+}
+
+/* Travessia breadth-first paralela com otimização de direção
+   Em grafos com diâmetro pequeno (redes sociais), a orla cresce muito depressa: a meio da travessia, quase todas as arestas examinadas
+a partir da orla chegam a vértices já visitados. Há duas formas de calcular o próximo nível:
+   -> top-down (como em travessiaBreadthFirst): para cada v da orla, examinar os sucessores; custa as arestas que saem da orla (mf);
+   -> bottom-up: para cada vértice v ainda não visitado, procurar um antecessor (no grafo transposto) que esteja na orla, parando no primeiro;
+      custa, no máximo, as arestas que chegam aos vértices por visitar (mu), mas normalmente muito menos.
+   Escolhemos em cada nível (heurística de Beamer et al.): passar a bottom-up se mf > mu / BFS_ALFA e voltar a top-down quando a orla tiver
+menos do que V / BFS_BETA vértices.
+   Paralelização (nThreads threads, com uma barreira no fim de cada nível):
+   -> Os vértices visitados e a orla no modo bottom-up são bitmaps (um bit por vértice, em palavras de 64 bits);
+   -> top-down: a orla (uma queue) é repartida pelas threads. Como dois vértices da orla podem ter o mesmo sucessor, a marcação como visitado
+      é um "fetch-or" atómico, e só a thread que mudou o bit define pais e o coloca na sua queue local, que é copiada para a próxima orla
+      (reservando espaço com um "fetch-add") quando enche;
+   -> bottom-up: as threads repartem os vértices em blocos de 64 (uma palavra dos bitmaps), logo, cada palavra só é escrita por uma thread e
+      não são precisas operações atómicas.
+   Os resultados (alc e pais) são os mesmos de travessiaBreadthFirstCSR, exceto que pais[v] pode ser qualquer antecessor de v no nível anterior.
+*/
+
+#define BFS_ALFA 14
+#define BFS_BETA 24
+#define BFS_LOCAL 1024
+
+#define BIT(b, v) (((b)[(v) >> 6] >> ((v) & 63)) & 1)
+
+typedef struct {
+    GrafoCSR *g, *gt;
+    int nThreads, palavras;
+    int *pais;
+    uint64_t *visitado, *fronteira, *proxima;
+    int *fila, *proxFila, tamFila, tamProx;
+    int bottomUp, fim;
+    long mf, mu, nf;
+    pthread_barrier_t barreira;
+} BFSPar;
+
+typedef struct {
+    BFSPar *b;
+    int id;
+} ArgBFS;
+
+// Função auxiliar que copia a queue local para a próxima orla
+static void flushBFS (BFSPar *b, int local[], int *n)
+{
+    int pos = __atomic_fetch_add (&b->tamProx, *n, __ATOMIC_RELAXED);
+    memcpy (b->proxFila + pos, local, *n * sizeof(int));
+    *n = 0;
+}
+
+// Função auxiliar que decide o modo do próximo nível e prepara a orla correspondente (só a thread 0)
+static void proximoNivel (BFSPar *b)
+{
+    GrafoCSR *g = b->g;
+    int *t, i, v;
+    uint64_t *tb, w;
+    if (b->nf == 0){
+        b->fim = 1;
+        return;
+    }
+    b->mu -= b->mf;
+    if (!b->bottomUp){
+        t = b->fila; b->fila = b->proxFila; b->proxFila = t;
+        b->tamFila = b->tamProx;
+        b->tamProx = 0;
+        if (b->mf > b->mu / BFS_ALFA){   // passar a bottom-up: orla como bitmap
+            b->bottomUp = 1;
+            memset (b->fronteira, 0, b->palavras * sizeof(uint64_t));
+            for (i = 0; i < b->tamFila; i++){
+                v = b->fila[i];
+                b->fronteira[v >> 6] |= (uint64_t) 1 << (v & 63);
+            }
+        }
+    }
+    else {
+        tb = b->fronteira; b->fronteira = b->proxima; b->proxima = tb;
+        if (b->nf < g->nv / BFS_BETA){   // voltar a top-down: orla como queue
+            b->bottomUp = 0;
+            b->tamFila = b->tamProx = 0;
+            for (i = 0; i < b->palavras; i++)
+                for (w = b->fronteira[i]; w != 0; w &= w - 1)
+                    b->fila[b->tamFila++] = (i << 6) + __builtin_ctzll (w);
+        }
+    }
+    b->mf = b->nf = 0;
+}
+
+void *workerBFS (void *arg)
+{
+    ArgBFS *a = arg;
+    BFSPar *b = a->b;
+    GrafoCSR *g = b->g, *gt = b->gt;
+    int local[BFS_LOCAL], n, i, j, v, d, ini, fim;
+    long mf, nf;
+    uint64_t bit, velho, w;
+    while (!b->fim){
+        mf = nf = 0;
+        if (!b->bottomUp){
+            n = 0;
+            ini = (long) b->tamFila * a->id / b->nThreads;
+            fim = (long) b->tamFila * (a->id + 1) / b->nThreads;
+            for (i = ini; i < fim; i++){
+                v = b->fila[i];
+                for (j = g->offsets[v]; j < g->offsets[v + 1]; j++){
+                    d = g->destino[j];
+                    bit = (uint64_t) 1 << (d & 63);
+                    if (__atomic_load_n (&b->visitado[d >> 6], __ATOMIC_RELAXED) & bit) continue;
+                    velho = __atomic_fetch_or (&b->visitado[d >> 6], bit, __ATOMIC_RELAXED);
+                    if (velho & bit) continue;   // outra thread chegou primeiro
+                    b->pais[d] = v;
+                    mf += g->offsets[d + 1] - g->offsets[d];
+                    nf++;
+                    local[n++] = d;
+                    if (n == BFS_LOCAL) flushBFS (b, local, &n);
+                }
+            }
+            flushBFS (b, local, &n);
+        }
+        else {
+            memset (b->proxima + (long) b->palavras * a->id / b->nThreads, 0,
+                    ((long) b->palavras * (a->id + 1) / b->nThreads - (long) b->palavras * a->id / b->nThreads) * sizeof(uint64_t));
+            for (i = (long) b->palavras * a->id / b->nThreads; i < (long) b->palavras * (a->id + 1) / b->nThreads; i++)
+                for (w = ~b->visitado[i]; w != 0; w &= w - 1){
+                    v = (i << 6) + __builtin_ctzll (w);
+                    if (v >= g->nv) break;
+                    for (j = gt->offsets[v]; j < gt->offsets[v + 1]; j++)
+                        if (BIT(b->fronteira, gt->destino[j])){
+                            b->pais[v] = gt->destino[j];
+                            b->visitado[i] |= (uint64_t) 1 << (v & 63);
+                            b->proxima[i] |= (uint64_t) 1 << (v & 63);
+                            mf += g->offsets[v + 1] - g->offsets[v];
+                            nf++;
+                            break;
+                        }
+                }
+        }
+        __atomic_fetch_add (&b->mf, mf, __ATOMIC_RELAXED);
+        __atomic_fetch_add (&b->nf, nf, __ATOMIC_RELAXED);
+        pthread_barrier_wait (&b->barreira);
+        if (a->id == 0) proximoNivel (b);
+        pthread_barrier_wait (&b->barreira);
+    }
+    return NULL;
+}
+
+// Função que faz uma travessia breadth-first a partir de o com nThreads threads (gt é o transposto de g, ver csrTransposta); devolve o nº de vértices alcançados
+int travessiaBreadthFirstPar (GrafoCSR *g, GrafoCSR *gt, int o, int alc[], int pais[], int nThreads)
+{
+    BFSPar b;
+    ArgBFS *as;
+    pthread_t *ts;
+    int v, r = 0;
+    if (nThreads < 1) nThreads = 1;
+    b.g = g;
+    b.gt = gt;
+    b.nThreads = nThreads;
+    b.palavras = (g->nv + 63) / 64;
+    b.pais = pais;
+    b.visitado = calloc (b.palavras, sizeof(uint64_t));
+    b.fronteira = calloc (b.palavras, sizeof(uint64_t));
+    b.proxima = calloc (b.palavras, sizeof(uint64_t));
+    b.fila = malloc (g->nv * sizeof(int));
+    b.proxFila = malloc (g->nv * sizeof(int));
+    for (v = 0; v < g->nv; v++) pais[v] = -2;
+    pais[o] = -1;
+    b.visitado[o >> 6] |= (uint64_t) 1 << (o & 63);
+    b.fila[0] = o;
+    b.tamFila = 1;
+    b.tamProx = 0;
+    b.bottomUp = b.fim = 0;
+    b.mf = b.nf = 0;
+    b.mu = g->na - (g->offsets[o + 1] - g->offsets[o]);
+    pthread_barrier_init (&b.barreira, NULL, nThreads);
+    ts = malloc (nThreads * sizeof(pthread_t));
+    as = malloc (nThreads * sizeof(ArgBFS));
+    for (v = 0; v < nThreads; v++){
+        as[v] = (ArgBFS) { &b, v };
+        if (v > 0) pthread_create (&ts[v], NULL, workerBFS, &as[v]);
+    }
+    workerBFS (&as[0]);
+    for (v = 1; v < nThreads; v++) pthread_join (ts[v], NULL);
+    pthread_barrier_destroy (&b.barreira);
+    for (v = 0; v < g->nv; v++){
+        alc[v] = BIT(b.visitado, v);
+        r += alc[v];
+    }
+    free (ts);
+    free (as);
+    free (b.visitado);
+    free (b.fronteira);
+    free (b.proxima);
+    free (b.fila);
+    free (b.proxFila);
+    return r;
+}
+
+/* Caminho mais curto entre dois vértices
+   O DijkstraSP calcula a árvore de caminhos mais curtos a partir de o para todos os vértices. Quando só interessa o caminho de o para d:
+   -> Dijkstra bidirecional: um Dijkstra a partir de o (em g) e outro a partir de d (no transposto gt), avançando em cada passo o lado cuja orla
+      tem o menor mínimo. Sempre que uma aresta (u, v) liga os dois lados, W_o[u] + p(u, v) + W_d[v] é um caminho candidato (mu guarda o melhor).
+      Critério de paragem: quando min(orla de o) + min(orla de d) >= mu, nenhum caminho ainda não examinado pode ser mais curto do que mu.
+      (Parar quando um vértice fica Preto dos dois lados não chega: esse vértice não tem de estar no caminho mais curto.)
+   -> A*: Dijkstra a partir de o em que a orla é ordenada por W[v] + h(v), com h(v) uma estimativa da distância de v a d que nunca a excede
+      (heurística admissível). Termina quando d é retirado da orla. Se h não for consistente, um vértice Preto pode voltar à orla.
+   As duas devolvem a distância de o a d (-1 se d não for alcançável) e colocam em *tratados o nº de vértices retirados das orlas, que é a medida
+do trabalho feito (um DijkstraSP trata todos os vértices alcançáveis).
+*/
+
+// Função auxiliar que relaxa as arestas de v num dos lados do Dijkstra bidirecional (b, W, pais) e atualiza mu com o outro lado (bo, Wo)
+static void relaxaBi (ListaAdj x, int v, Buffers *b, int W[], int pais[], Buffers *bo, int Wo[], int *mu, int *meio)
+{
+    int d;
+    for (; x != NULL; x = x->prox){
+        d = x->destino;
+        if (COR(b, d) == Branco){
+            PINTA(b, d, Cinzento);
+            W[d] = W[v] + x->peso;
+            pais[d] = v;
+            insertHeapIdx (&b->heap, d, W[d]);
+        }
+        else if (COR(b, d) == Cinzento && W[v] + x->peso < W[d]){
+            W[d] = W[v] + x->peso;
+            pais[d] = v;
+            decreaseKey (&b->heap, d, W[d]);
+        }
+        if (COR(bo, d) != Branco && W[v] + x->peso + Wo[d] < *mu){
+            *mu = W[v] + x->peso + Wo[d];
+            *meio = d;
+        }
+    }
+}
+
+// Função que calcula a distância de o a d com um Dijkstra bidirecional (gt é o transposto de g; bo e bd são os Buffers de cada lado)
+// Wo / paisO ficam com o lado de o e Wd / paisD com o lado de d (paisD[v] é o vértice seguinte a v no caminho para d); *meio é um vértice do caminho
+int DijkstraBi (GrafoL g, GrafoL gt, int o, int d, int Wo[], int paisO[], int Wd[], int paisD[], Buffers *bo, Buffers *bd, int *meio, int *tratados)
+{
+    int mu = INT_MAX, v = -1, ko, kd;
+    novaConsulta (bo);
+    novaConsulta (bd);
+    *tratados = 0;
+    Wo[o] = 0;
+    paisO[o] = -1;
+    PINTA(bo, o, Cinzento);
+    insertHeapIdx (&bo->heap, o, 0);
+    Wd[d] = 0;
+    paisD[d] = -1;
+    PINTA(bd, d, Cinzento);
+    insertHeapIdx (&bd->heap, d, 0);
+    if (o == d){
+        *meio = o;
+        return 0;
+    }
+    while (bo->heap.used > 0 && bd->heap.used > 0){
+        ko = bo->heap.chave[bo->heap.values[0]];
+        kd = bd->heap.chave[bd->heap.values[0]];
+        if (mu != INT_MAX && ko + kd >= mu) break;
+        (*tratados)++;
+        if (ko <= kd){
+            extractMinIdx (&bo->heap, &v);
+            PINTA(bo, v, Preto);
+            relaxaBi (g->adj[v], v, bo, Wo, paisO, bd, Wd, &mu, meio);
+        }
+        else {
+            extractMinIdx (&bd->heap, &v);
+            PINTA(bd, v, Preto);
+            relaxaBi (gt->adj[v], v, bd, Wd, paisD, bo, Wo, &mu, meio);
+        }
+    }
+    return (mu == INT_MAX) ? -1 : mu;
+}
+
+// Função que coloca em cam o caminho encontrado pelo DijkstraBi (o, ..., d) e devolve o seu nº de vértices
+int caminhoBi (int paisO[], int paisD[], int meio, int cam[])
+{
+    int n = 0, v, t;
+    for (v = meio; v != -1; v = paisO[v]) cam[n++] = v;
+    for (v = 0; v < n / 2; v++){
+        t = cam[v];
+        cam[v] = cam[n - 1 - v];
+        cam[n - 1 - v] = t;
+    }
+    for (v = paisD[meio]; v != -1; v = paisD[v]) cam[n++] = v;
+    return n;
+}
+
+typedef int (*Heuristica) (int v, void *ctx);   // estimativa (admissível) da distância de v ao destino
+
+// Função que calcula a distância de o a d com o algoritmo A* (W e pais como no DijkstraSP, mas só para os vértices tratados)
+int aEstrela (GrafoL g, int o, int d, Heuristica h, void *ctx, int W[], int pais[], Buffers *b, int *tratados)
+{
+    HeapIdx *orla = &b->heap;
+    ListaAdj x;
+    int v, u;
+    novaConsulta (b);
+    *tratados = 0;
+    W[o] = 0;
+    pais[o] = -1;
+    PINTA(b, o, Cinzento);
+    insertHeapIdx (orla, o, h (o, ctx));
+    while (extractMinIdx (orla, &v)){
+        (*tratados)++;
+        PINTA(b, v, Preto);
+        if (v == d) return W[d];
+        for (x = g->adj[v]; x != NULL; x = x->prox){
+            u = x->destino;
+            if (COR(b, u) == Branco || W[v] + x->peso < W[u]){
+                W[u] = W[v] + x->peso;
+                pais[u] = v;
+                if (COR(b, u) == Cinzento) decreaseKey (orla, u, W[u] + h (u, ctx));
+                else {
+                    PINTA(b, u, Cinzento);   // novo, ou Preto reaberto (heurística não consistente)
+                    insertHeapIdx (orla, u, W[u] + h (u, ctx));
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+/* Comparação: numa grelha lado x lado com pesos em [1, maxPeso] (ver grelhaCSR), a distância de Manhattan entre v e d é uma heurística admissível
+e consistente, pois cada aresta custa pelo menos 1.
+*/
+
+// Função que cria uma grelha lado x lado com pesos em [1, maxPeso] (arestas nos dois sentidos entre vizinhos)
+GrafoL grelhaL (int lado, int maxPeso)
+{
+    GrafoL g = novoGrafoL (lado * lado);
+    int v;
+    for (v = 0; v < lado * lado; v++){
+        if (v % lado + 1 < lado){
+            addArestaL (g, v, v + 1, 1 + rand () % maxPeso);
+            addArestaL (g, v + 1, v, 1 + rand () % maxPeso);
+        }
+        if (v + lado < lado * lado){
+            addArestaL (g, v, v + lado, 1 + rand () % maxPeso);
+            addArestaL (g, v + lado, v, 1 + rand () % maxPeso);
+        }
+    }
+    return g;
+}
+
+typedef struct {
+    int lado, destino;
+} CtxGrelha;
+
+int manhattan (int v, void *ctx)
+{
+    CtxGrelha *c = ctx;
+    return abs (v % c->lado - c->destino % c->lado) + abs (v / c->lado - c->destino / c->lado);
+}
+
+// Função que compara DijkstraSP, DijkstraBi e aEstrela em nConsultas pares aleatórios (tempo e média de vértices tratados por consulta)
+void benchPontoAPonto (int lado, int maxPeso, int nConsultas)
+{
+    GrafoL g = grelhaL (lado, maxPeso), gt = transpostaL (g);
+    int n = g->nv, i, o, d, meio, t, dist;
+    int *alc = malloc (n * sizeof(int)), *pais = malloc (n * sizeof(int)), *W = malloc (n * sizeof(int));
+    int *W2 = malloc (n * sizeof(int)), *pais2 = malloc (n * sizeof(int));
+    long trat[3] = {0};
+    double tempo[3] = {0};
+    struct timespec t0, t1;
+    CtxGrelha c = { lado, 0 };
+    Buffers b, b2;
+    initBuffers (&b, n);
+    initBuffers (&b2, n);
+    for (i = 0; i < nConsultas; i++){
+        o = rand () % n;
+        d = c.destino = rand () % n;
+        clock_gettime (CLOCK_MONOTONIC, &t0);
+        trat[0] += DijkstraSP (g, o, alc, pais, W, &b);
+        dist = W[d];
+        clock_gettime (CLOCK_MONOTONIC, &t1);
+        tempo[0] += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+        if (DijkstraBi (g, gt, o, d, W, pais, W2, pais2, &b, &b2, &meio, &t) != dist) printf ("DijkstraBi: distância errada\n");
+        clock_gettime (CLOCK_MONOTONIC, &t0);
+        tempo[1] += (t0.tv_sec - t1.tv_sec) + (t0.tv_nsec - t1.tv_nsec) / 1e9;
+        trat[1] += t;
+        if (aEstrela (g, o, d, manhattan, &c, W, pais, &b, &t) != dist) printf ("aEstrela: distância errada\n");
+        clock_gettime (CLOCK_MONOTONIC, &t1);
+        tempo[2] += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+        trat[2] += t;
+    }
+    printf ("grelha %dx%d: DijkstraSP %.0f vértices, %.3f ms | DijkstraBi %.0f vértices, %.3f ms | A* %.0f vértices, %.3f ms\n", lado, lado,
+            (double) trat[0] / nConsultas, tempo[0] * 1e3 / nConsultas, (double) trat[1] / nConsultas, tempo[1] * 1e3 / nConsultas,
+            (double) trat[2] / nConsultas, tempo[2] * 1e3 / nConsultas);
+    freeBuffers (&b);
+    freeBuffers (&b2);
+    freeGrafoL (g);
+    freeGrafoL (gt);
+    free (alc); free (pais); free (W); free (W2); free (pais2);
+}
+
+/* Delta-stepping (caminhos mais curtos a partir de o, em paralelo)
+   No Dijkstra, só um vértice sai da orla de cada vez. No delta-stepping, os vértices são agrupados em baldes pela sua distância provisória:
+o balde i tem os vértices com W em [i * delta, (i + 1) * delta[. As arestas dividem-se em leves (peso <= delta) e pesadas (peso > delta):
+   -> tratamos sempre o primeiro balde não vazio, i, com todos os seus vértices em paralelo;
+   -> relaxar uma aresta leve pode colocar um vértice no próprio balde i, logo, as arestas leves são relaxadas em rondas até o balde i ficar
+      estável (os vértices cujo W melhorou e continua no balde i formam a orla da ronda seguinte);
+   -> no fim, as arestas pesadas dos vértices tratados são relaxadas uma única vez, pois levam sempre a baldes > i.
+   Com delta = 1 (e pesos inteiros) é essencialmente o algoritmo de Dial; com delta = infinito é o Bellman-Ford. Um bom delta, para pesos em
+[0, maxPeso], é cerca de maxPeso / (grau médio), que é o valor usado quando delta <= 0 é passado.
+   Paralelização (nThreads threads, com barreiras entre fases):
+   -> W[v] e pais[v] são guardados juntos numa palavra de 64 bits (W nos 32 bits de cima), e o relaxamento é um "mínimo atómico" com
+      compare-and-swap, logo, pais[v] corresponde sempre a W[v];
+   -> cada thread tem os seus próprios baldes (não partilhados), num array circular com maxPeso / delta + 2 posições (as distâncias provisórias
+      estão sempre entre a do balde atual e essa mais maxPeso);
+   -> os baldes não são atualizados quando W[v] diminui: uma entrada de v num balde que já não corresponde a W[v] é simplesmente ignorada.
+   Preenche alc, pais e W como o DijkstraSP (que deve dar as mesmas distâncias) e devolve o nº de vértices alcançados.
+*/
+
+typedef struct {
+    GrafoCSR *g;
+    int delta, nb, nThreads;
+    uint64_t *dp;          // (W << 32) | pais
+    Balde *baldes;         // baldes[t * nb + (i % nb)] -> balde i da thread t
+    Balde *tratados;       // vértices tratados por cada thread no balde atual
+    int *fr, *prox, nFr, nProx;
+    unsigned *marcaFr, *marcaS, iter, ronda;
+    int cur, fim;
+    pthread_barrier_t barreira;
+} DeltaStep;
+
+typedef struct {
+    DeltaStep *s;
+    int id;
+} ArgDS;
+
+#define DS_W(s, v) ((int) (__atomic_load_n (&(s)->dp[v], __ATOMIC_RELAXED) >> 32))
+
+// Função auxiliar que relaxa a aresta v -> d com a nova distância nd (devolve 1 se W[d] diminuiu)
+static int relaxaDS (uint64_t *dp, int v, int d, int nd)
+{
+    uint64_t novo = ((uint64_t) nd << 32) | (uint32_t) v, velho = __atomic_load_n (&dp[d], __ATOMIC_RELAXED);
+    while ((velho >> 32) > (uint64_t) nd)
+        if (__atomic_compare_exchange_n (&dp[d], &velho, novo, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return 1;
+    return 0;
+}
+
+// Função auxiliar que relaxa as arestas de v com peso em ]min, max] (as leves ou as pesadas)
+static void relaxaArestasDS (DeltaStep *s, int id, int v, int min, int max)
+{
+    GrafoCSR *g = s->g;
+    int i, d, nd, wv = DS_W(s, v);
+    for (i = g->offsets[v]; i < g->offsets[v + 1]; i++){
+        if (g->peso[i] <= min || g->peso[i] > max) continue;
+        d = g->destino[i];
+        nd = wv + g->peso[i];
+        if (!relaxaDS (s->dp, v, d, nd)) continue;
+        if (nd / s->delta == s->cur){   // continua no balde atual: vai para a próxima orla (uma só vez)
+            if (__atomic_exchange_n (&s->marcaFr[d], s->iter + 1, __ATOMIC_RELAXED) != s->iter + 1)
+                s->prox[__atomic_fetch_add (&s->nProx, 1, __ATOMIC_RELAXED)] = d;
+        }
+        else pushBalde (&s->baldes[id * s->nb + (nd / s->delta) % s->nb], nd, d);
+    }
+}
+
+// Função auxiliar (só a thread 0) que procura o próximo balde não vazio
+static void proximoBaldeDS (DeltaStep *s)
+{
+    int j, t;
+    s->iter++;
+    s->ronda++;
+    for (j = s->cur + 1; j <= s->cur + s->nb; j++)
+        for (t = 0; t < s->nThreads; t++)
+            if (s->baldes[t * s->nb + j % s->nb].n > 0){
+                s->cur = j;
+                return;
+            }
+    s->fim = 1;
+}
+
+void *workerDS (void *arg)
+{
+    ArgDS *a = arg;
+    DeltaStep *s = a->s;
+    Balde *bk;
+    int i, v;
+    for (;;){
+        if (a->id == 0) proximoBaldeDS (s);
+        pthread_barrier_wait (&s->barreira);
+        if (s->fim) break;
+        bk = &s->baldes[a->id * s->nb + s->cur % s->nb];   // orla inicial: entradas ainda válidas do balde atual
+        for (i = 0; i < bk->n; i++){
+            v = bk->e[i].v;
+            if (DS_W(s, v) / s->delta == s->cur && __atomic_exchange_n (&s->marcaFr[v], s->iter, __ATOMIC_RELAXED) != s->iter)
+                s->fr[__atomic_fetch_add (&s->nFr, 1, __ATOMIC_RELAXED)] = v;
+        }
+        bk->n = 0;
+        s->tratados[a->id].n = 0;
+        pthread_barrier_wait (&s->barreira);
+        while (s->nFr > 0){   // arestas leves, em rondas
+            for (i = (long) s->nFr * a->id / s->nThreads; i < (long) s->nFr * (a->id + 1) / s->nThreads; i++){
+                v = s->fr[i];
+                if (__atomic_exchange_n (&s->marcaS[v], s->ronda, __ATOMIC_RELAXED) != s->ronda)
+                    pushBalde (&s->tratados[a->id], 0, v);
+                relaxaArestasDS (s, a->id, v, -1, s->delta);
+            }
+            pthread_barrier_wait (&s->barreira);
+            if (a->id == 0){
+                int *t = s->fr;
+                s->fr = s->prox;
+                s->prox = t;
+                s->nFr = s->nProx;
+                s->nProx = 0;
+                s->iter++;
+            }
+            pthread_barrier_wait (&s->barreira);
+        }
+        for (i = 0; i < s->tratados[a->id].n; i++)   // arestas pesadas
+            relaxaArestasDS (s, a->id, s->tratados[a->id].e[i].v, s->delta, INT_MAX);
+        pthread_barrier_wait (&s->barreira);
+    }
+    return NULL;
+}
+
+int deltaStepping (GrafoCSR *g, int o, int alc[], int pais[], int W[], int delta, int nThreads)
+{
+    DeltaStep s;
+    ArgDS *as;
+    pthread_t *ts;
+    int maxPeso = 0, i, r = 0;
+    uint64_t x;
+    if (nThreads < 1) nThreads = 1;
+    for (i = 0; i < g->na; i++)
+        if (g->peso[i] > maxPeso) maxPeso = g->peso[i];
+    if (delta <= 0){   // delta automático: maxPeso / grau médio
+        delta = (g->na > 0) ? (int) ((long) maxPeso * g->nv / g->na) : 1;
+        if (delta < 1) delta = 1;
+    }
+    s.g = g;
+    s.delta = delta;
+    s.nb = maxPeso / delta + 2;
+    s.nThreads = nThreads;
+    s.dp = malloc (g->nv * sizeof(uint64_t));
+    s.baldes = calloc ((size_t) nThreads * s.nb, sizeof(Balde));
+    s.tratados = calloc (nThreads, sizeof(Balde));
+    s.fr = malloc (g->nv * sizeof(int));
+    s.prox = malloc (g->nv * sizeof(int));
+    s.marcaFr = calloc (g->nv, sizeof(unsigned));
+    s.marcaS = calloc (g->nv, sizeof(unsigned));
+    s.nFr = s.nProx = 0;
+    s.iter = s.ronda = 0;
+    s.cur = -1;
+    s.fim = 0;
+    for (i = 0; i < g->nv; i++) s.dp[i] = ((uint64_t) UINT32_MAX << 32) | (uint32_t) -2;
+    s.dp[o] = (uint32_t) -1;
+    pushBalde (&s.baldes[0], 0, o);
+    pthread_barrier_init (&s.barreira, NULL, nThreads);
+    ts = malloc (nThreads * sizeof(pthread_t));
+    as = malloc (nThreads * sizeof(ArgDS));
+    for (i = 0; i < nThreads; i++){
+        as[i] = (ArgDS) { &s, i };
+        if (i > 0) pthread_create (&ts[i], NULL, workerDS, &as[i]);
+    }
+    workerDS (&as[0]);
+    for (i = 1; i < nThreads; i++) pthread_join (ts[i], NULL);
+    pthread_barrier_destroy (&s.barreira);
+    for (i = 0; i < g->nv; i++){
+        x = s.dp[i];
+        alc[i] = ((x >> 32) != UINT32_MAX);
+        pais[i] = (int) (uint32_t) x;
+        if (alc[i]){
+            W[i] = (int) (x >> 32);
+            r++;
+        }
+    }
+    for (i = 0; i < nThreads * s.nb; i++) free (s.baldes[i].e);
+    for (i = 0; i < nThreads; i++) free (s.tratados[i].e);
+    free (s.baldes);
+    free (s.tratados);
+    free (s.dp);
+    free (s.fr);
+    free (s.prox);
+    free (s.marcaFr);
+    free (s.marcaS);
+    free (ts);
+    free (as);
+    return r;
+}
+
+/* Grafos em matriz de bits
+   A linha o de um GrafoBits são g->palavras palavras de 64 bits: o bit (d % 64) da palavra (d / 64) diz se existe a aresta o -> d. Os bits
+de padding (d >= nv) ficam sempre a 0, logo, as operações sobre linhas inteiras (contar bits, AND de duas linhas) não precisam de tratar o fim
+da linha à parte.
+   As contagens usam o popcount do processador (__builtin_popcountll, compilar com -mpopcnt ou -march=native). Com AVX2 (__AVX2__ definido),
+as linhas são percorridas de 256 em 256 bits: o popcount de cada byte é obtido com duas consultas a uma tabela de 16 posições (uma por cada
+metade do byte, com _mm256_shuffle_epi8) e os bytes são somados com _mm256_sad_epu8.
+*/
+
+#define LINHA(g, o) ((g)->m + (size_t) (o) * (g)->palavras) // 1ª palavra da linha o
+
+// Função que reserva um grafo em matriz de bits com nv vértices e sem arestas
+void initBits (GrafoBits *g, int nv)
+{
+    size_t tam;
+    g->nv = nv;
+    g->na = 0;
+    g->palavras = (nv + 255) / 256 * 4;
+    tam = (size_t) nv * g->palavras * sizeof(uint64_t);
+    g->m = aligned_alloc (32, tam > 0 ? tam : 32);
+    memset (g->m, 0, tam);
+}
+
+void freeBits (GrafoBits *g)
+{
+    free (g->m);
+}
+
+void addArestaBits (GrafoBits *g, int o, int d)
+{
+    uint64_t b = (uint64_t) 1 << (d % 64);
+    if (!(LINHA(g, o)[d / 64] & b)) g->na++;
+    LINHA(g, o)[d / 64] |= b;
+}
+
+// Função que constrói um grafo em matriz de bits a partir de uma matriz de adjacência (os pesos perdem-se)
+void bitsFromM (GrafoBits *g, GrafoM m)
+{
+    int o, d;
+    initBits (g, m->nv);
+    for (o = 0; o < m->nv; o++)
+        for (d = 0; d < m->nv; d++)
+            if (PESO(m, o, d) != NE) addArestaBits (g, o, d);
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V^2)
+
+// Função que constrói um grafo em matriz de bits a partir de uma lista de adjacência (os pesos e as arestas repetidas perdem-se)
+void bitsFromL (GrafoBits *g, GrafoL l)
+{
+    int o;
+    ListaAdj x;
+    initBits (g, l->nv);
+    for (o = 0; o < l->nv; o++)
+        for (x = l->adj[o]; x != NULL; x = x->prox)
+            addArestaBits (g, o, x->destino);
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V + E) (mais Theta(V^2 / 64) para limpar a matriz)
+
+#ifdef __AVX2__
+// Função auxiliar que devolve, em cada uma das 4 posições de 64 bits, o nº de bits a 1 dessa posição de v
+static inline __m256i popcount256 (__m256i v)
+{
+    const __m256i tabela = _mm256_setr_epi8 (0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8 (0x0f);
+    __m256i c = _mm256_add_epi8 (_mm256_shuffle_epi8 (tabela, _mm256_and_si256 (v, nibble)),
+                                 _mm256_shuffle_epi8 (tabela, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nibble)));
+    return _mm256_sad_epu8 (c, _mm256_setzero_si256 ());
+}
+
+// Função auxiliar que soma as 4 posições de 64 bits de v
+static inline long soma256 (__m256i v)
+{
+    return _mm256_extract_epi64 (v, 0) + _mm256_extract_epi64 (v, 1) + _mm256_extract_epi64 (v, 2) + _mm256_extract_epi64 (v, 3);
+}
+#endif
+
+// Função auxiliar que conta os bits a 1 das n palavras a partir de a
+static long popcountBits (const uint64_t *a, size_t n)
+{
+    long r = 0;
+    size_t i = 0;
+#ifdef __AVX2__
+    __m256i acc = _mm256_setzero_si256 ();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_add_epi64 (acc, popcount256 (_mm256_loadu_si256 ((const __m256i *) (a + i))));
+    r = soma256 (acc);
+#endif
+    for (; i < n; i++) r += __builtin_popcountll (a[i]);
+    return r;
+}
+
+// Função auxiliar que conta os bits a 1 em (a AND b), com n palavras
+static long popcountE (const uint64_t *a, const uint64_t *b, size_t n)
+{
+    long r = 0;
+    size_t i = 0;
+#ifdef __AVX2__
+    __m256i acc = _mm256_setzero_si256 ();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_add_epi64 (acc, popcount256 (_mm256_and_si256 (_mm256_loadu_si256 ((const __m256i *) (a + i)),
+                                                                     _mm256_loadu_si256 ((const __m256i *) (b + i)))));
+    r = soma256 (acc);
+#endif
+    for (; i < n; i++) r += __builtin_popcountll (a[i] & b[i]);
+    return r;
+}
+
+int haArestaBits (GrafoBits *g, int o, int d)
+{
+    return ((LINHA(g, o)[d / 64] >> (d % 64)) & 1);
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(1)
+
+int contaArestasBits (GrafoBits *g)
+{
+    return (int) popcountBits (g->m, (size_t) g->nv * g->palavras);   // igual a g->na
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V^2 / 64)
+
+// Função que calcula o grau de saída do vértice o
+int grauBits (GrafoBits *g, int o)
+{
+    return (int) popcountBits (LINHA(g, o), g->palavras);
+}
+
+int outDegreeBits (GrafoBits *g)
+{
+    int o, r = 0, t;
+    for (o = 0; o < g->nv; o++){
+        t = grauBits (g, o);
+        if (t > r) r = t;
+    }
+    return r;
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V^2 / 64)
+
+/* Função que calcula os vizinhos comuns de u e v (os vértices w com arestas u -> w e v -> w), ou seja, o AND das linhas u e v.
+   Devolve quantos são e, se r != NULL, coloca-os (por ordem crescente) em r.
+*/
+int vizinhosComunsBits (GrafoBits *g, int u, int v, int r[])
+{
+    uint64_t *lu = LINHA(g, u), *lv = LINHA(g, v), x;
+    int k, n = 0;
+    if (r == NULL) return (int) popcountE (lu, lv, g->palavras);
+    for (k = 0; k < g->palavras; k++)
+        for (x = lu[k] & lv[k]; x != 0; x &= x - 1)   // x &= x - 1 apaga o bit a 1 mais baixo
+            r[n++] = 64 * k + __builtin_ctzll (x);
+    return n;
+}
+// A Complexidade desta função é dada por: T(V,E) = Theta(V / 64) (mais o nº de vizinhos comuns, se r != NULL)
+
+/* Função que conta os triângulos {u, v, w} de um grafo não orientado (a matriz tem de ser simétrica e sem lacetes).
+   Cada triângulo é contado uma só vez, com u < v < w: para cada aresta u - v com u < v, contamos os w > v que são vizinhos de u e de v, ou seja,
+os bits a 1 em (linha u AND linha v) a partir da posição v + 1.
+*/
+long contaTriangulosBits (GrafoBits *g)
+{
+    long r = 0;
+    int u, v, k, j;
+    uint64_t *lu, *lv, x;
+    for (u = 0; u < g->nv; u++){
+        lu = LINHA(g, u);
+        for (k = (u + 1) / 64; k < g->palavras; k++)
+            for (x = lu[k] & (k == (u + 1) / 64 ? ~(uint64_t) 0 << ((u + 1) % 64) : ~(uint64_t) 0); x != 0; x &= x - 1){
+                v = 64 * k + __builtin_ctzll (x);
+                lv = LINHA(g, v);
+                j = (v + 1) / 64;
+                if (j < g->palavras)
+                    r += __builtin_popcountll (lu[j] & lv[j] & (~(uint64_t) 0 << ((v + 1) % 64)))
+                       + popcountE (lu + j + 1, lv + j + 1, g->palavras - j - 1);
+            }
+    }
+    return r;
+}
+// A Complexidade desta função é dada por: T(V,E) = O(E * V / 64)
+
+// Compara contaArestasM/outDegreeM com as versões em matriz de bits, num grafo não orientado aleatório com nv vértices e densidade dada (em %)
+void benchBits (int nv, int densidade)
+{
+    GrafoM m = novoGrafoM (nv);
+    GrafoBits g;
+    struct timespec t0, t1, t2;
+    int o, d, a1, a2, g1, g2;
+    long tri;
+    srand (nv);
+    for (o = 0; o < nv; o++)
+        for (d = o + 1; d < nv; d++)
+            if (rand () % 100 < densidade){
+                addArestaM (m, o, d, 1);
+                addArestaM (m, d, o, 1);
+            }
+    bitsFromM (&g, m);
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    a1 = contaArestasM (m);
+    g1 = outDegreeM (m);
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    a2 = contaArestasBits (&g);
+    g2 = outDegreeBits (&g);
+    clock_gettime (CLOCK_MONOTONIC, &t2);
+    printf ("nv %d, densidade %d%%: %d arestas, grau %d%s\n", nv, densidade, a1, g1, (a1 == a2 && g1 == g2) ? "" : " (ERRO)");
+    printf ("  memória: matriz %zu KiB, bits %zu KiB\n", (size_t) nv * nv * sizeof(int) / 1024, (size_t) nv * g.palavras * sizeof(uint64_t) / 1024);
+    printf ("  contaArestas + outDegree: matriz %.3f ms, bits %.3f ms\n",
+            (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6, (t2.tv_sec - t1.tv_sec) * 1e3 + (t2.tv_nsec - t1.tv_nsec) / 1e6);
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    tri = contaTriangulosBits (&g);
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    printf ("  %ld triângulos em %.3f ms\n", tri, (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    freeBits (&g);
+    freeGrafoM (m);
+}